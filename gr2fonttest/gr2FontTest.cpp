@@ -61,6 +61,7 @@ public:
     int testFileFont() const;
     gr_feature_val* parseFeatures(const gr_face * face) const;
     void printFeatures(const gr_face * face) const;
+    void printProfile(const gr_face * face) const;
 public:
     const char * fileName;
     const char * features;
@@ -382,7 +383,12 @@ bool Parameters::loadFromArgs(int argc, char *argv[])
                 else if (strcmp(argv[a], "-demand") == 0)
                 {
                     option = NONE;
-                    opts = gr_face_default;
+                    opts = gr_face_options(opts & gr_face_collectProfile);
+                }
+                else if (strcmp(argv[a], "-profile") == 0)
+                {
+                    option = NONE;
+                    opts = gr_face_options(opts | gr_face_collectProfile);
                 }
                 else
                 {
@@ -603,6 +609,32 @@ gr_feature_val * Parameters::parseFeatures(const gr_face * face) const
     return featureList;
 }
 
+void Parameters::printProfile(const gr_face * face) const
+{
+    fprintf(log, "\nProfile\nsilf pass  rule     fsm  considered constraints   passed  actions  instructions      cycles\n");
+    for (unsigned int silf = 0; gr_face_profile(face, silf, 0, -1, NULL) >= 0; ++silf)
+    {
+        gr_profile_counts c;
+        int numRules;
+        for (unsigned int pass = 0; (numRules = gr_face_profile(face, silf, pass, -1, &c)) >= 0; ++pass)
+        {
+            fprintf(log, "%4u %4u     -%8lu %11lu %11lu %8lu %8lu %13lu %11llu\n", silf, pass,
+                    (unsigned long)c.fsm_runs, (unsigned long)c.rules_considered,
+                    (unsigned long)c.constraints_run, (unsigned long)c.constraints_passed,
+                    (unsigned long)c.actions_run, (unsigned long)c.instructions, c.cycles);
+            for (int rule = 0; rule < numRules; ++rule)
+            {
+                gr_face_profile(face, silf, pass, rule, &c);
+                if (c.rules_considered == 0) continue;
+                fprintf(log, "%4u %4u %5d        %11lu %11lu %8lu %8lu %13lu %11llu\n", silf, pass, rule,
+                        (unsigned long)c.rules_considered,
+                        (unsigned long)c.constraints_run, (unsigned long)c.constraints_passed,
+                        (unsigned long)c.actions_run, (unsigned long)c.instructions, c.cycles);
+            }
+        }
+    }
+}
+
 int Parameters::testFileFont() const
 {
     int returnCode = 0;
@@ -731,6 +763,8 @@ int Parameters::testFileFont() const
         }
         if (pSeg)
             gr_seg_destroy(pSeg);
+        if (opts & gr_face_collectProfile)
+            printProfile(face);
         if (featureList) gr_featureval_destroy(featureList);
         gr_font_destroy(sizedFont);
         if (trace) gr_stop_logging(face);
@@ -773,6 +807,7 @@ int main(int argc, char *argv[])
         fprintf(stderr,"-log out.log\tSet log file to use rather than stdout\n");
         fprintf(stderr,"-trace trace.json\tDefine a file for the JSON trace log\n");
         fprintf(stderr,"-demand\tDemand load glyphs and cmap cache\n");
+        fprintf(stderr,"-profile\tPrint per pass and per rule execution counts\n");
         fprintf(stderr,"-bytes\tword size for character transfer [1,2,4] defaults to 4\n");
         return 1;
     }
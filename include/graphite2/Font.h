@@ -39,7 +39,13 @@ enum gr_face_options {
     /** Cache the lookup from code point to glyph ID at construction time */
     gr_face_cacheCmap = 4,
     /** Preload everything */
-    gr_face_preloadAll = gr_face_preloadGlyphs | gr_face_cacheCmap
+    gr_face_preloadAll = gr_face_preloadGlyphs | gr_face_cacheCmap,
+    /** Count per pass and per rule execution statistics, see gr_face_profile() */
+    gr_face_collectProfile = 8,
+    /** Copy the lookup from code point to glyph ID into native byte order at construction
+      * time. Quicker to make and smaller than gr_face_cacheCmap, which takes precedence,
+      * though slower to look up in. */
+    gr_face_nativeCmap = 16
 };
 
 /** Holds information about a particular Graphite silf table that has been loaded */
@@ -63,6 +69,23 @@ struct gr_faceinfo {
 
 typedef struct gr_faceinfo gr_faceinfo;
 
+/** Execution counts for a pass or a rule, collected when a face is made with
+  * gr_face_collectProfile. Counts accumulate over all segments made with the
+  * face.
+  */
+struct gr_profile_counts {
+    size_t fsm_runs;            /**< Number of times the pass state machine was run */
+    size_t rules_considered;    /**< Rules matched by the state machine and tried */
+    size_t constraints_run;     /**< Rule constraints evaluated */
+    size_t constraints_passed;  /**< Rule constraints which passed */
+    size_t actions_run;         /**< Rule actions executed */
+    size_t instructions;        /**< VM instructions executed by the constraints and actions run */
+    size_t collision_fixes;     /**< Glyphs the shift collider tried to move out of collision, in the pass totals only */
+    unsigned long long cycles;  /**< Processor timestamp ticks spent, estimated by sampling; 0 where unavailable */
+};
+
+typedef struct gr_profile_counts gr_profile_counts;
+
 /** type describing function to retrieve font table information
   *
   * @return a pointer to the table in memory. The pointed to memory must exist as
@@ -173,6 +196,32 @@ GR2_API void gr_tag_to_str(gr_uint32 tag, char *str);
   */
 GR2_API gr_feature_val* gr_face_featureval_for_lang(const gr_face* pFace, gr_uint32 langname);
 
+/** Get the face's own feature values for a given language or default
+  *
+  * As gr_face_featureval_for_lang, but nothing is copied: the result is the face's
+  * interned copy, as from gr_face_intern_featureval. It must not be destroyed or changed.
+  *
+  * @return the face's feature values for the language, or NULL if the face has no room
+  *          left to intern them.
+  * @param pFace The font face to get feature values from
+  * @param langname As for gr_face_featureval_for_lang.
+  */
+GR2_API const gr_feature_val* gr_face_default_featureval(const gr_face* pFace, gr_uint32 langname);
+
+/** Get the face's interned copy of some feature values
+  *
+  * A face keeps one copy of each different set of feature values interned with it, so
+  * interned copies are equal exactly when their pointers are, and may key a cache.
+  * They last as long as the face and may be passed anywhere a gr_feature_val is taken,
+  * but must not be destroyed or changed. A face interns at most 256 different sets,
+  * and may run out of room for a set before that.
+  *
+  * @return the interned copy, or NULL if pFeats is NULL or the face has no room left.
+  * @param pFace The font face the feature values are for
+  * @param pFeats The feature values to intern. They are copied, not kept.
+  */
+GR2_API const gr_feature_val* gr_face_intern_featureval(const gr_face* pFace, const gr_feature_val* pFeats);
+
 /** Get feature reference for a given feature id from a face
   *
   * @return a feature reference corresponding to the given id. This data is part of the gr_face and
@@ -203,6 +252,36 @@ GR2_API unsigned short gr_face_n_glyphs(const gr_face* pFace);
 /** Returns a faceinfo for the face and script **/
 GR2_API const gr_faceinfo *gr_face_info(const gr_face *pFace, gr_uint32 script);
 
+/** Retrieves the profile counts for a pass or one of its rules.
+  *
+  * @return the number of rules in the pass, or -1 if profiling is not enabled
+  *         for this face or the silf, pass or rule does not exist.
+  * @param pFace    face made with gr_face_collectProfile
+  * @param silf     index of the silf subtable, usually 0
+  * @param pass     index of the pass within the silf subtable
+  * @param rule     index of the rule within the pass, or -1 for the pass totals
+  * @param counts   receives the counts, may be NULL
+  */
+GR2_API int gr_face_profile(const gr_face *pFace, unsigned int silf, unsigned int pass, int rule, gr_profile_counts *counts);
+
+/** Limits the collision fixing done for each segment made with the face.
+  *
+  * Collision passes first fix each glyph once and then refine the results
+  * over several more iterations. Each glyph fixed counts against the budget,
+  * and once it is used up no more refinement is done for the segment; the
+  * rest of its glyphs keep the positions they had. Set this before making
+  * segments with the face, not while they are being made.
+  *
+  * @param pFace        face to set the budget for
+  * @param maxFixes     most glyph fixes per segment, or 0 for no limit (the default)
+  */
+GR2_API void gr_face_set_collision_budget(gr_face *pFace, unsigned int maxFixes);
+
+/** Returns the number of segments made with the face whose collision budget
+  * was used up before the collision passes were done with them.
+  */
+GR2_API size_t gr_face_collision_budget_trips(const gr_face *pFace);
+
 /** Returns whether the font supports a given Unicode character
   *
   * @return true if the character is supported.
@@ -212,6 +291,59 @@ GR2_API const gr_faceinfo *gr_face_info(const gr_face *pFace, gr_uint32 script);
   */
 GR2_API int gr_face_is_char_supported(const gr_face *pFace, gr_uint32 usv, gr_uint32 script);
 
+/** Returns the Unicode characters a face supports, as a bitset
+  *
+  * Bit (usv & 31) of word (usv >> 5) is set for each character gr_face_is_char_supported
+  * would say is supported. The set is made the first time it is asked for and kept with the
+  * face, so the pointer stays good until the face is destroyed. It ends after the last word
+  * holding any supported character; nothing from *pLimit on is supported.
+  *
+  * @return the bitset, or NULL if there was no memory for it.
+  * @param pFace    face to look in
+  * @param pLimit   If not NULL, receives the first character past the end of the bitset,
+  *                 a multiple of 32.
+  */
+GR2_API const gr_uint32 * gr_face_coverage(const gr_face *pFace, gr_uint32 *pLimit);
+
+/** Finds for each character of some text the first of several faces to support it
+  *
+  * This is for choosing fallback fonts. Each character is looked up in the coverage bitset,
+  * as from gr_face_coverage, of each face in turn. Runs of printable ASCII that the same
+  * face is first for are dealt with a block at a time.
+  *
+  * @return the number of characters looked up. This is less than nChars only if the text
+  *         is badly encoded, or if there was no memory.
+  * @param pFaces       faces in order of preference. A NULL entry supports nothing.
+  * @param nFaces       number of faces in pFaces
+  * @param enc          encoding of the text
+  * @param pStart       start of the text
+  * @param nChars       number of characters in the text
+  * @param pFaceIndex   array of nChars ints which receives, for each character, the index in
+  *                     pFaces of the first face supporting it, or -1 if none does.
+  */
+GR2_API size_t gr_faces_first_supporting(const gr_face * const *pFaces, size_t nFaces, enum gr_encform enc, const void *pStart, size_t nChars, int *pFaceIndex);
+
+/** Reads in ahead of time the glyphs that shaping some text will need
+  *
+  * A face made without gr_face_preloadGlyphs reads in each glyph the first time a segment
+  * uses it, which slows the first segments made with it. This shapes the text once with the
+  * face's default features, reading in the glyph for each character along with every glyph
+  * the rules make from them in that context, and anything else shaping them needs, such as
+  * the collision boxes. To warm a face for a set of characters rather than some sample text,
+  * pass them as UTF-32. Glyphs that only other contexts would make are still read in when
+  * first used. Text may be of any length, such as a whole corpus, and is shaped a piece at a
+  * time. This changes the face, so it must not be called while other threads are making
+  * segments with it.
+  *
+  * @return the number of glyphs read in. This is 0 for a face made with gr_face_preloadGlyphs.
+  * @param pFace    face to read glyphs into
+  * @param enc      encoding of the text
+  * @param pStart   start of the text
+  * @param nChars   number of characters in the text. Any nul or badly encoded character
+  *                 ends it early.
+  */
+GR2_API size_t gr_face_preload_text(const gr_face *pFace, enum gr_encform enc, const void *pStart, size_t nChars);
+
 #ifndef GRAPHITE2_NFILEFACE
 /** Create gr_face from a font file
   *
@@ -248,6 +380,10 @@ GR2_API gr_font* gr_make_font(float ppm, const gr_face *face);
  */
 typedef float (*gr_advance_fn)(const void* appFontHandle, gr_uint16 glyphid);
 
+/** type describing function to retrieve the advances of many glyphs in one call.
+  * It must set advances[i] for each of the n glyphids[i]. */
+typedef void (*gr_advances_fn)(const void* appFontHandle, const gr_uint16 *glyphids, size_t n, float *advances);
+
 /** struct housing function pointers to manage font hinted metrics for the
   * graphite engine. */
 struct gr_font_ops
@@ -264,6 +400,12 @@ struct gr_font_ops
           * provide without client assistance.  This can be
           * NULL to signify no horizontal hinted metrics are necessary. */
     gr_advance_fn       glyph_advance_y;
+        /** a pointer to a function to retrieve the hinted
+          * advance widths of many glyphs at once. Before positioning
+          * a segment the engine asks for those of all its glyphs it
+          * has not seen before in one call, leaving glyph_advance_x
+          * for any it then finds it still needs. This may be NULL. */
+    gr_advances_fn      glyph_advances_x;
 };
 typedef struct gr_font_ops  gr_font_ops;
 
@@ -360,6 +502,9 @@ GR2_API gr_feature_val* gr_featureval_clone(const gr_feature_val* pfeatures);
 /** Destroys a gr_feature_val **/
 GR2_API void gr_featureval_destroy(gr_feature_val *pfeatures);
 
+/** Returns a hash of a gr_feature_val; equal feature values have equal hashes **/
+GR2_API gr_uint32 gr_featureval_hash(const gr_feature_val* pfeatures);
+
 #ifdef __cplusplus
 }
 #endif
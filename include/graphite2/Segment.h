@@ -157,6 +157,15 @@ typedef struct gr_char_info     gr_char_info;
 typedef struct gr_segment       gr_segment;
 typedef struct gr_slot          gr_slot;
 
+/** A run of characters in a segment with their own feature settings */
+struct gr_feature_run {
+    size_t start;                   /**< Index of the first character in the run */
+    size_t length;                  /**< Number of characters in the run */
+    const gr_feature_val *features; /**< Feature settings for the run, not NULL */
+};
+
+typedef struct gr_feature_run   gr_feature_run;
+
 /** Returns Unicode character for a charinfo.
   *
   * @param p Pointer to charinfo to return information on.
@@ -244,6 +253,67 @@ GR2_API size_t gr_count_unicode_characters(enum gr_encform enc, const void* buff
   */
 GR2_API gr_segment* gr_make_seg(const gr_font* font, const gr_face* face, gr_uint32 script, const gr_feature_val* pFeats, enum gr_encform enc, const void* pStart, size_t nChars, int dir);
 
+/** Creates and returns a segment for the characters in a buffer.
+  *
+  * This does what gr_count_unicode_characters followed by gr_make_seg would, but
+  * decodes the string only once, counting its characters as they are read in.
+  *
+  * @return a segment that needs seg_destroy called on it. Returns NULL if there is
+  *     a structural fault in the string or bad problems in segment processing.
+  * @param font As for gr_make_seg.
+  * @param face As for gr_make_seg.
+  * @param script As for gr_make_seg.
+  * @param pFeats As for gr_make_seg.
+  * @param enc Specifies what encoding form the string is in (utf8, utf16, utf32)
+  * @param pStart Start of the string
+  * @param pEnd Process up to the first nul or when end is reached, whichever is
+  *             earliest. This parameter may be NULL.
+  * @param dir As for gr_make_seg.
+  * @param pError As for gr_count_unicode_characters. NULL may be passed.
+  */
+GR2_API gr_segment* gr_make_seg_from_buffer(const gr_font* font, const gr_face* face, gr_uint32 script, const gr_feature_val* pFeats, enum gr_encform enc, const void* pStart, const void* pEnd, int dir, const void** pError);
+
+/** Creates and returns a segment from glyphs already mapped from characters.
+  *
+  * For callers that do their own character to glyph mapping, such as font fallback.
+  * Each glyph takes the place of one character, so the cmap is never consulted.
+  *
+  * @return a segment that needs seg_destroy called on it. May return NULL if bad problems
+  *     in segment processing.
+  * @param font As for gr_make_seg.
+  * @param face As for gr_make_seg.
+  * @param script As for gr_make_seg.
+  * @param pFeats As for gr_make_seg.
+  * @param pGlyphs The glyph ids to shape. Glyph ids not in the face are taken as 0.
+  * @param pOffsets For each glyph the index of the character in the caller's text it
+  *               came from, as returned by gr_cinfo_base. If NULL the glyph's own index
+  *               is used.
+  * @param pChars For each glyph the Unicode character it came from, as returned by
+  *               gr_cinfo_unicode_char and used by justification to find spaces.
+  *               May be NULL.
+  * @param nGlyphs Number of glyphs in pGlyphs and in pOffsets and pChars if given.
+  * @param dir As for gr_make_seg.
+  */
+GR2_API gr_segment* gr_make_seg_from_glyphs(const gr_font* font, const gr_face* face, gr_uint32 script, const gr_feature_val* pFeats, const gr_uint16* pGlyphs, const size_t* pOffsets, const gr_uint32* pChars, size_t nGlyphs, int dir);
+
+/** Creates and returns a segment whose characters do not all share the same features.
+  *
+  * Runs of text that differ only in their features, such as a span of small caps,
+  * can so be shaped together, with rules seeing context across the runs. Rules
+  * start only where the features of a run allow their pass to run.
+  *
+  * @return a segment that needs seg_destroy called on it. May return NULL if bad problems
+  *     in segment processing, or if there are more than 256 different feature settings.
+  * @param pFeats Feature values for characters in no run. If NULL the default features
+  *               for the font will be used.
+  * @param pRuns Runs of characters with their own features. Where runs overlap the
+  *              later run wins.
+  * @param nRuns Number of runs in pRuns.
+  *
+  * The other parameters are as for gr_make_seg.
+  */
+GR2_API gr_segment* gr_make_seg_with_feature_runs(const gr_font* font, const gr_face* face, gr_uint32 script, const gr_feature_val* pFeats, enum gr_encform enc, const void* pStart, size_t nChars, int dir, const gr_feature_run* pRuns, size_t nRuns);
+
 /** Destroys a segment, freeing the memory.
   *
   * @param p The segment to destroy
@@ -302,6 +372,36 @@ GR2_API const gr_slot* gr_seg_last_slot(gr_segment* pSeg/*not NULL*/);    //may
   */
 GR2_API float gr_seg_justify(gr_segment* pSeg/*not NULL*/, const gr_slot* pStart/*not NULL*/, const gr_font *pFont, double width, enum gr_justFlags flags, const gr_slot* pFirst, const gr_slot* pLast);
 
+/** Justifies several lines of a segment to the same width
+  *
+  * Each line is a linked list of slots set up by gr_slot_linebreak_before, and is justified
+  * just as gr_seg_justify would with pFirst and pLast NULL. Justifying a paragraph's lines in
+  * one call saves setting up afresh for each of them.
+  *
+  * @param pSeg     Pointer to the segment
+  * @param pStarts  Array of pointers to the start of each line's linked list
+  * @param numLines Number of lines in pStarts
+  * @param pFont    Font to use for positioning
+  * @param width    Width in pixels in which to fit each line, as for gr_seg_justify
+  * @param flags    Indicates line ending types, applied to every line
+  * @param pWidths  If not NULL, an array of numLines floats which receives the resulting width of each line
+  */
+GR2_API void gr_seg_justify_lines(gr_segment* pSeg/*not NULL*/, const gr_slot* const* pStarts/*not NULL*/, size_t numLines, const gr_font *pFont, double width, enum gr_justFlags flags, float *pWidths);
+
+/** Positions a segment's glyphs afresh for another font
+  *
+  * Shaping does not depend on the font, only the final positioning does. So a segment
+  * may be made once, perhaps with a NULL font to give design units, and then placed for
+  * as many font sizes as are wanted in turn without running its passes again. The positions
+  * and advance come out just as if the segment had been made with pFont in the first place,
+  * collision offsets included. Lines justified before need justifying again afterwards.
+  *
+  * @param pSeg     Pointer to the segment
+  * @param pFont    Font to position for, which must be of the segment's face. If NULL
+  *                 positions are given in design units.
+  */
+GR2_API void gr_seg_rescale(gr_segment* pSeg/*not NULL*/, const gr_font *pFont);
+
 /** Returns the next slot along in the segment.
   *
   * Slots are held in a linked list. This returns the next in the linked list. The slot
@@ -4,13 +4,49 @@
 
 #include "inc/Main.h"
 #include "inc/CmapCache.h"
+#include "inc/Endian.h"
 #include "inc/Face.h"
 #include "inc/TtfTypes.h"
 #include "inc/TtfUtil.h"
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define GRAPHITE2_CMAP_SSE2
+#include <emmintrin.h>
+#endif
+
 
 using namespace graphite2;
 
+namespace
+{
+#if defined GRAPHITE2_CMAP_SSE2
+    inline __m128i swapped(const __m128i v, const uint16 *)
+    {
+        return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+
+    inline __m128i swapped(const __m128i v, const uint32 *)
+    {
+        return swapped(_mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1), static_cast<const uint16 *>(0));
+    }
+#endif
+
+    // Copies n big endian values from src to dst in native byte order,
+    // sixteen bytes at a time where SSE2 can (x86 being little endian).
+    template <typename T>
+    void decode(T * dst, const byte * src, size_t n)
+    {
+        size_t i = 0;
+#if defined GRAPHITE2_CMAP_SSE2
+        for (const size_t step = 16 / sizeof(T); n - i >= step; i += step, src += 16)
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i),
+                             swapped(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), dst));
+#endif
+        for (; i != n; ++i, src += sizeof(T))
+            dst[i] = be::peek<T>(src);
+    }
+}
+
 const void * bmp_subtable(const Face::Table & cmap)
 {
     const void * stbl;
@@ -60,6 +96,25 @@ bool cache_subtable(uint16 * blocks[], const void * cst, const unsigned int limi
     return true;
 }
 
+template <unsigned int (*NextCodePoint)(const void *, unsigned int, int *),
+          uint16 (*LookupCodePoint)(const void *, unsigned int, int)>
+void cover_subtable(uint32 * bits, const void * cst, const unsigned int first, const unsigned int limit)
+{
+    int rangeKey = 0;
+    uint32          codePoint = NextCodePoint(cst, 0, &rangeKey),
+                    prevCodePoint = 0;
+    while (codePoint < limit)
+    {
+        if (codePoint >= first && LookupCodePoint(cst, codePoint, rangeKey))
+            bits[codePoint >> 5] |= 1u << (codePoint & 31);
+        // prevent infinite loop
+        if (codePoint <= prevCodePoint)
+            codePoint = prevCodePoint + 1;
+        prevCodePoint = codePoint;
+        codePoint =  NextCodePoint(cst, codePoint, &rangeKey);
+    }
+}
+
 
 CachedCmap::CachedCmap(const Face & face)
 : m_isBmpOnly(true),
@@ -110,6 +165,19 @@ CachedCmap::operator bool() const throw()
     return m_blocks != 0;
 }
 
+void CachedCmap::cover(uint32 * bits) const throw()
+{
+    const unsigned int numBlocks = m_isBmpOnly ? 0x100 : 0x1100;
+    for (unsigned int block = 0; block != numBlocks; ++block)
+    {
+        const uint16 * const glyphs = m_blocks[block];
+        if (!glyphs) continue;
+        for (unsigned int i = 0; i != 0x100; ++i)
+            if (glyphs[i])
+                bits[(block << 3) + (i >> 5)] |= 1u << (i & 31);
+    }
+}
+
 
 DirectCmap::DirectCmap(const Face & face)
 : _cmap(face, Tag::cmap),
@@ -130,3 +198,206 @@ DirectCmap::operator bool () const throw()
     return _cmap && _bmp;
 }
 
+// Only the BMP subtable is looked in for BMP characters, as in operator [].
+void DirectCmap::cover(uint32 * bits) const throw()
+{
+    if (_smp)
+        cover_subtable<TtfUtil::CmapSubtable12NextCodepoint, TtfUtil::CmapSubtable12Lookup>(bits, _smp, 0x10000, 0x10FFFF);
+    if (_bmp)
+        cover_subtable<TtfUtil::CmapSubtable4NextCodepoint, TtfUtil::CmapSubtable4Lookup>(bits, _bmp, 0, 0xFFFF);
+}
+
+
+NativeCmap::NativeCmap(const Face & face)
+: m_bmp(0),
+  m_groups(0),
+  m_numGroups(0),
+  m_bmpLength(0),
+  m_numSegs(0)
+{
+    const Face::Table cmap(face, Tag::cmap);
+    const byte * const bmp_cmap = static_cast<const byte *>(bmp_subtable(cmap));
+    const byte * const smp_cmap = static_cast<const byte *>(smp_subtable(cmap));
+    if (!bmp_cmap) return;
+
+    m_bmpLength = be::peek<uint16>(bmp_cmap + 2) / 2;
+    m_bmp = gralloc<uint16>(m_bmpLength);
+    if (!m_bmp) return;
+    decode(m_bmp, bmp_cmap, m_bmpLength);
+    m_numSegs = m_bmp[3] / 2;
+
+    if (smp_cmap)
+    {
+        const uint32 numGroups = be::peek<uint32>(smp_cmap + 12);
+        uint32 * const groups = gralloc<uint32>(numGroups * 3);
+        if (!groups)
+        {
+            free(m_bmp);
+            m_bmp = 0;
+            return;
+        }
+        decode(groups, smp_cmap + 16, numGroups * 3);
+        bool sorted = true;
+        for (uint32 i = 0; i < numGroups && sorted; ++i)
+            sorted = groups[i * 3] <= groups[i * 3 + 1] && groups[i * 3 + 1] <= 0x10FFFF
+                  && (i == 0 || groups[i * 3] > groups[i * 3 - 2]);
+        m_groups = groups;
+        m_numGroups = sorted ? numGroups : sort_groups(groups, numGroups);
+    }
+}
+
+namespace
+{
+    int cmp_group(const void * a, const void * b)
+    {
+        const uint32 * const l = static_cast<const uint32 *>(a),
+                     * const r = static_cast<const uint32 *>(b);
+        for (int i = 0; i != 3; ++i)
+            if (l[i] != r[i]) return l[i] < r[i] ? -1 : 1;
+        return 0;
+    }
+}
+
+// The groups are meant to be in order, apart and within Unicode.  Should they
+// not be, put them in order, drop the empty ones and trim each where it
+// overlaps those before it, so they can always be searched.  Returns how many
+// are left.
+uint32 NativeCmap::sort_groups(uint32 * groups, uint32 numGroups) throw()
+{
+    qsort(groups, numGroups, 3 * sizeof(uint32), &cmp_group);
+    uint32 n = 0, next = 0;
+    for (const uint32 * g = groups, * const ge = g + numGroups * 3; g != ge; g += 3)
+    {
+        const uint32 end = min(g[1], 0x10FFFFu);
+        if (g[0] > end || end < next) continue;
+        const uint32 start = max(g[0], next);
+        groups[n * 3] = start;
+        groups[n * 3 + 1] = end;
+        groups[n * 3 + 2] = g[2] + (start - g[0]);
+        ++n;
+        next = end + 1;
+    }
+    return n;
+}
+
+NativeCmap::~NativeCmap() throw()
+{
+    free(m_bmp);
+    free(m_groups);
+}
+
+// As TtfUtil::CmapSubtable4Lookup, without a byte swap at each step.
+inline
+uint16 NativeCmap::bmp(const uint32 usv) const throw()
+{
+    const uint16 * const ends = m_bmp + 7;
+    const uint16 * left = ends, * mid = 0;
+    for (uint16 n = m_numSegs; n; )
+    {
+        const uint16 half = n >> 1;
+        mid = left + half;
+        if (usv <= *mid)
+        {
+            if (half == 0 || usv > mid[-1]) break;
+            n = half;
+        }
+        else
+        {
+            left = mid + 1;
+            n -= half + 1;
+        }
+        mid = 0;
+    }
+    if (!mid) return 0;
+
+    const uint16 * const start = mid + m_numSegs + 1;
+    if (usv < *start) return 0;
+    const uint16 delta = start[m_numSegs];
+    const uint16 * const rangeOffset = start + 2 * m_numSegs;
+    if (*rangeOffset == 0)
+        return uint16(delta + usv);
+
+    const size_t offset = (usv - *start) + (*rangeOffset >> 1) + (rangeOffset - m_bmp);
+    if (offset >= m_bmpLength) return 0;
+    const uint16 gid = m_bmp[offset];
+    return gid ? uint16(gid + delta) : 0;
+}
+
+inline
+uint16 NativeCmap::smp(const uint32 usv) const throw()
+{
+    uint32 lo = 0, hi = m_numGroups;
+    while (lo != hi)
+    {
+        const uint32 mid = (lo + hi) >> 1;
+        if (m_groups[mid * 3 + 1] < usv)    lo = mid + 1;
+        else                                hi = mid;
+    }
+    const uint32 * const g = m_groups + lo * 3;
+    return lo != m_numGroups && usv >= g[0] ? uint16(g[2] + usv - g[0]) : 0;
+}
+
+uint16 NativeCmap::operator [] (const uint32 usv) const throw()
+{
+    return usv > 0xFFFF ? (m_groups ? smp(usv) : 0) : bmp(usv);
+}
+
+NativeCmap::operator bool () const throw()
+{
+    return m_bmp != 0;
+}
+
+// Each code point is tried at most once, however the segments overlap.
+void NativeCmap::cover(uint32 * bits) const throw()
+{
+    const uint16 * const ends = m_bmp + 7, * const starts = ends + m_numSegs + 1;
+    bool ordered = true;
+    for (uint16 i = 1; i < m_numSegs && ordered; ++i)
+        ordered = ends[i] > ends[i - 1];
+    uint32 next = 0;
+    for (uint16 i = 0; i != m_numSegs; ++i)
+    {
+        // Segments out of order, which the search cannot rely on, are
+        // covered by trying the whole BMP.
+        const uint32 end = ordered ? ends[i] : 0xFFFF;
+        for (uint32 usv = ordered ? max<uint32>(starts[i], next) : next; usv <= end; ++usv)
+            if (bmp(usv))
+                bits[usv >> 5] |= 1u << (usv & 31);
+        next = max(next, end + 1);
+    }
+    // The groups are in order and apart, so just read off their glyphs.
+    for (const uint32 * g = m_groups, * const ge = g + m_numGroups * 3; g != ge; g += 3)
+        for (uint32 usv = max(g[0], 0x10000u); usv <= g[1]; ++usv)
+            if (uint16(g[2] + usv - g[0]))
+                bits[usv >> 5] |= 1u << (usv & 31);
+}
+
+
+Coverage::Coverage(const Face & face) throw()
+: m_bits(grzeroalloc<uint32>(0x110000 >> 5)),
+  m_limit(0)
+{
+    if (!m_bits) return;
+
+    face.cmap().cover(m_bits);
+    const Silf * const silf = face.chooseSilf(0);
+    for (uint16 i = 0, n = silf ? silf->numPseudo() : 0; i != n; ++i)
+    {
+        const uint32 usv = silf->pseudo(i).uid;
+        if (usv < 0x110000 && silf->findPseudo(usv))
+            m_bits[usv >> 5] |= 1u << (usv & 31);
+    }
+
+    // Give back the words past the last character covered.
+    size_t words = 0x110000 >> 5;
+    while (words > 1 && !m_bits[words - 1]) --words;
+    m_limit = uint32(words << 5);
+    uint32 * const bits = static_cast<uint32 *>(realloc(m_bits, words * sizeof(uint32)));
+    if (bits) m_bits = bits;
+}
+
+Coverage::~Coverage() throw()
+{
+    free(m_bits);
+}
+
@@ -742,18 +742,25 @@ void Machine::Code::release_buffers() throw()
 }
 
 
-int32 Machine::Code::run(Machine & m, slotref * & map) const
+bool Machine::Code::refsInRange(Machine & m) const
 {
-//    assert(_own);
-    assert(*this);          // Check we are actually runnable
-
     if (m.slotMap().size() <= size_t(_max_ref + m.slotMap().context())
         || m.slotMap()[_max_ref + m.slotMap().context()] == 0)
     {
         m._status = Machine::slot_offset_out_bounds;
+        return false;
+    }
+    return true;
+}
+
+int32 Machine::Code::run(Machine & m, slotref * & map) const
+{
+//    assert(_own);
+    assert(*this);          // Check we are actually runnable
+
+    if (!refsInRange(m))
         return 1;
 //        return m.run(_code, _data, map);
-    }
 
     return  m.run(_code, _data, map);
 }
@@ -10,6 +10,7 @@
 #include "inc/Segment.h"
 #include "inc/Slot.h"
 #include "inc/GlyphCache.h"
+#include "inc/SliceEdges.h"
 #include "inc/Sparse.h"
 
 #define ISQRT2 0.707106781f
@@ -22,6 +23,13 @@ using namespace graphite2;
 
 ////    SHIFT-COLLIDER    ////
 
+// Push a bound out by more than any difference in rounding between two ways
+// of computing it could amount to.
+static inline float loosen(float v, int dir)
+{
+    return v + dir * (1.f + 1e-5f * std::fabs(v));
+}
+
 // Initialize the Collider to hold the basic movement limits for the
 // target slot, the one we are focusing on fixing.
 bool ShiftCollider::initSlot(Segment *seg, Slot *aSlot, const Rect &limit, float margin, float marginWeight,
@@ -30,12 +38,12 @@ bool ShiftCollider::initSlot(Segment *seg, Slot *aSlot, const Rect &limit, float
     int i;
     float mx, mn;
     float a, shift;
-    const GlyphCache &gc = seg->getFace()->glyphs();
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
     unsigned short gid = aSlot->gid();
-    if (!gc.check(gid))
+    if (!geom || !geom->check(gid))
         return false;
-    const BBox &bb = gc.getBoundingBBox(gid);
-    const SlantBox &sb = gc.getBoundingSlantBox(gid);
+    const BBox &bb = geom->box(gid).bb;
+    const SlantBox &sb = geom->box(gid).sb;
     //float sx = aSlot->origin().x + currShift.x;
     //float sy = aSlot->origin().y + currShift.y;
     if (currOffset.x != 0.f || currOffset.y != 0.f)
@@ -253,11 +261,11 @@ bool ShiftCollider::mergeSlot(Segment *seg, Slot *slot, const SlotCollision *csl
     float omin, omax, otmin, otmax;
     float cmin, cmax;   // target limits
     float torg;
-    const GlyphCache &gc = seg->getFace()->glyphs();
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
     const unsigned short gid = slot->gid();
-    if (!gc.check(gid))
+    if (!geom || !geom->check(gid))
         return false;
-    const BBox &bb = gc.getBoundingBBox(gid);
+    const BBox &bb = geom->box(gid).bb;
 
     // SlotCollision * cslot = seg->collisionInfo(slot);
     int orderFlags = 0;
@@ -276,10 +284,10 @@ bool ShiftCollider::mergeSlot(Segment *seg, Slot *slot, const SlotCollision *csl
         const float ty = _currOffset.y + _currShift.y;
         const float td = tx - ty;
         const float ts = tx + ty;
-        const SlantBox &sb = gc.getBoundingSlantBox(gid);
+        const SlantBox &sb = geom->box(gid).sb;
         const unsigned short tgid = _target->gid();
-        const BBox &tbb = gc.getBoundingBBox(tgid);
-        const SlantBox &tsb = gc.getBoundingSlantBox(tgid);
+        const BBox &tbb = geom->box(tgid).bb;
+        const SlantBox &tsb = geom->box(tgid).sb;
         float seq_above_wt = cslot->seqAboveWt();
         float seq_below_wt = cslot->seqBelowWt();
         float seq_valign_wt = cslot->seqValignWt();
@@ -457,14 +465,15 @@ bool ShiftCollider::mergeSlot(Segment *seg, Slot *slot, const SlotCollision *csl
 
             // Process sub-boxes that are defined for this glyph.
             // We only need to do this if there was in fact a collision with the main octabox.
-            uint8 numsub = gc.numSubBounds(gid);
+            uint8 numsub = geom->numSubs(gid);
             if (numsub > 0)
             {
+                const CollisionBox * const subs = geom->subs(gid);
                 bool anyhits = false;
                 for (int j = 0; j < numsub; ++j)
                 {
-                    const BBox &sbb = gc.getSubBoundingBBox(gid, j);
-                    const SlantBox &ssb = gc.getSubBoundingSlantBox(gid, j);
+                    const BBox &sbb = subs[j].bb;
+                    const SlantBox &ssb = subs[j].sb;
                     switch (i) {
                         case 0 :    // x
                             vmin = max(max(sbb.xi-tbb.xa+sx, ssb.di-tsb.da+sd+ty), ssb.si-tsb.sa+ss-ty);
@@ -531,7 +540,7 @@ bool ShiftCollider::mergeSlot(Segment *seg, Slot *slot, const SlotCollision *csl
         }
     }
     bool res = true;
-    if (cslot->exclGlyph() > 0 && gc.check(cslot->exclGlyph()) && !isExclusion)
+    if (cslot->exclGlyph() > 0 && geom->check(cslot->exclGlyph()) && !isExclusion)
     {
         // Set up the bogus slot representing the exclusion glyph.
         Slot *exclSlot = seg->newSlot();
@@ -620,6 +629,68 @@ Position ShiftCollider::resolve(GR_MAYBE_UNUSED Segment *seg, bool &isCol, GR_MA
 }   // end of ShiftCollider::resolve
 
 
+// The regions, one per axis and in the same coordinates as slot origins, at
+// least one of which a neighbour's octabox has to meet for mergeSlot to find
+// anything.  Each bounds the neighbour's extents by every term of that
+// axis's test, and is widened to allow for the different rounding of the
+// test it stands in for.
+void ShiftCollider::reach(Segment *seg, OctaBounds regions[4]) const
+{
+    const CollisionBox &tgb = seg->getFace()->glyphs().collisionGeometry()->box(_target->gid());
+    const BBox &tbb = tgb.bb;
+    const SlantBox &tsb = tgb.sb;
+    const float tx = _currOffset.x + _currShift.x;
+    const float ty = _currOffset.y + _currShift.y;
+    const float td = tx - ty;
+    const float ts = tx + ty;
+    const float dmargin = _margin / ISQRT2;
+    float cmin, cmax;
+    OctaBounds *r = regions;
+
+    // x direction
+    cmin = _limit.bl.x + _currOffset.x - _margin;
+    cmax = _limit.tr.x - tbb.xi + tbb.xa + _currOffset.x + _margin;
+    r->xi = cmin + tbb.xi;              r->xa = cmax + tbb.xa;
+    r->yi = tbb.yi + ty - _margin;      r->ya = tbb.ya + ty + _margin;
+    r->di = cmin + tsb.di - ty;         r->da = cmax + tsb.da - ty;
+    r->si = cmin + tsb.si + ty;         r->sa = cmax + tsb.sa + ty;
+    ++r;
+    // y direction
+    cmin = _limit.bl.y + _currOffset.y - _margin;
+    cmax = _limit.tr.y - tbb.yi + tbb.ya + _currOffset.y + _margin;
+    r->xi = tbb.xi + tx - _margin;      r->xa = tbb.xa + tx + _margin;
+    r->yi = cmin + tbb.yi;              r->ya = cmax + tbb.ya;
+    r->di = tsb.di + tx - cmax;         r->da = tsb.da + tx - cmin;
+    r->si = cmin + tsb.si + tx;         r->sa = cmax + tsb.sa + tx;
+    ++r;
+    // sum
+    cmin = _limit.bl.x + _limit.bl.y + _currOffset.x + _currOffset.y - dmargin;
+    cmax = _limit.tr.x + _limit.tr.y - tsb.si + tsb.sa + _currOffset.x + _currOffset.y + dmargin;
+    r->xi = (cmin + td) / 2 + tbb.xi;   r->xa = (cmax + td) / 2 + tbb.xa;
+    r->yi = (cmin - td) / 2 + tbb.yi;   r->ya = (cmax - td) / 2 + tbb.ya;
+    r->di = tsb.di + td - dmargin;      r->da = tsb.da + td + dmargin;
+    r->si = cmin + tsb.si;              r->sa = cmax + tsb.sa;
+    ++r;
+    // diff
+    cmin = _limit.bl.x - _limit.tr.y + _currOffset.x - _currOffset.y - dmargin;
+    cmax = _limit.tr.x - _limit.bl.y - tsb.di + tsb.da + _currOffset.x - _currOffset.y + dmargin;
+    r->xi = (cmin + ts) / 2 + tbb.xi;   r->xa = (cmax + ts) / 2 + tbb.xa;
+    r->yi = (ts - cmax) / 2 + tbb.yi;   r->ya = (ts - cmin) / 2 + tbb.ya;
+    r->di = cmin + tsb.di;              r->da = cmax + tsb.da;
+    r->si = tsb.si + ts - dmargin;      r->sa = tsb.sa + ts + dmargin;
+
+    const float os = _origin.x + _origin.y,
+                od = _origin.x - _origin.y;
+    for (r = regions; r != regions + 4; ++r)
+    {
+        r->xi = loosen(r->xi + _origin.x, -1);  r->xa = loosen(r->xa + _origin.x, 1);
+        r->yi = loosen(r->yi + _origin.y, -1);  r->ya = loosen(r->ya + _origin.y, 1);
+        r->di = loosen(r->di + od, -1);         r->da = loosen(r->da + od, 1);
+        r->si = loosen(r->si + os, -1);         r->sa = loosen(r->sa + os, 1);
+    }
+}
+
+
 #if !defined GRAPHITE2_NTRACING
 
 void ShiftCollider::outputJsonDbg(json * const dbgout, Segment *seg, int axis)
@@ -716,84 +787,213 @@ void ShiftCollider::outputJsonDbgRemovals(json * const dbgout, int axis, Segment
 #endif // !defined GRAPHITE2_NTRACING
 
 
-////    KERN-COLLIDER    ////
+////    SLOT-INDEX    ////
 
-inline
-static float localmax (float al, float au, float bl, float bu, float x)
+int SlotIndex::cmpLeft(const void *a, const void *b)
 {
-    if (al < bl)
-    { if (au < bu) return au < x ? au : x; }
-    else if (au > bu) return bl < x ? bl : x;
-    return x;
+    const float l = static_cast<const Entry *>(a)->box.xi,
+                r = static_cast<const Entry *>(b)->box.xi;
+    return (l > r) - (l < r);
 }
 
-inline
-static float localmin(float al, float au, float bl, float bu, float x)
+// Index the slots from first up to, but not including, end.
+void SlotIndex::build(Segment *seg, Slot *first, Slot *end)
 {
-    if (bl > al)
-    { if (bu > au) return bl > x ? bl : x; }
-    else if (au > bu) return al > x ? al : x;
-    return x;
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
+    if (_posOf.size() != seg->slotCount())
+        _posOf.assign(seg->slotCount(), ~0U);
+    else
+        for (Slot * const *s = _slots.begin(); s != _slots.end(); ++s)
+            _posOf[(*s)->index()] = ~0U;
+    _entries.clear();
+    _slots.clear();
+    _revStop = 0;
+    _maxWidth = 0;
+    for (Slot *s = first; s != end; s = s->next())
+    {
+        const uint32 pos = uint32(_slots.size());
+        const SlotCollision *c = seg->collisionInfo(s);
+        if (pos && (c->flags() & SlotCollision::COLL_START) && s->next() != end)
+            _revStop = pos;
+        _posOf[s->index()] = pos;
+        _slots.push_back(s);
+    }
+
+    const size_t words = (_slots.size() + 31) >> 5;
+    _always.assign(words, 0);
+    _marks.resize(words);
+    _entries.resize(_slots.size());
+    _entryOf.resize(_slots.size());
+    for (uint32 pos = 0; pos != _slots.size(); ++pos)
+    {
+        Slot * const s = _slots[pos];
+        const uint16 excl = seg->collisionInfo(s)->exclGlyph();
+        // Slots mergeSlot cannot skip, or which bring an exclusion glyph
+        // along, get merged wherever their own box lies.
+        if (!geom || !geom->check(s->gid()) || excl > 0)
+            _always[pos >> 5] |= 1U << (pos & 31);
+        Entry &e = _entries[pos];
+        e.pos = pos;
+        place(seg, s, e);
+        _maxWidth = max(_maxWidth, e.box.xa - e.box.xi);
+    }
+    if (!_entries.empty())
+        qsort(_entries.begin(), _entries.size(), sizeof(Entry), &cmpLeft);
+    for (uint32 i = 0; i != _entries.size(); ++i)
+        _entryOf[_entries[i].pos] = i;
 }
 
-// Return the given edge of the glyph at height y, taking any slant box into account.
-static float get_edge(Segment *seg, const Slot *s, const Position &shift, float y, float width, float margin, bool isRight)
+void SlotIndex::place(Segment *seg, Slot *slot, Entry &e) const
 {
-    const GlyphCache &gc = seg->getFace()->glyphs();
-    unsigned short gid = s->gid();
-    float sx = s->origin().x + shift.x;
-    float sy = s->origin().y + shift.y;
-    uint8 numsub = gc.numSubBounds(gid);
-    float res = isRight ? (float)-1e38 : (float)1e38;
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
+    const Position p = slot->origin() + seg->collisionInfo(slot)->shift();
+    OctaBounds &b = e.box;
+    if (!geom || !geom->check(slot->gid()))
+    {
+        b.xi = b.xa = p.x;
+        b.yi = b.ya = p.y;
+        b.di = b.da = p.x - p.y;
+        b.si = b.sa = p.x + p.y;
+        return;
+    }
+    const BBox &bb = geom->box(slot->gid()).bb;
+    const SlantBox &sb = geom->box(slot->gid()).sb;
+    b.xi = p.x + bb.xi;         b.xa = p.x + bb.xa;
+    b.yi = p.y + bb.yi;         b.ya = p.y + bb.ya;
+    b.di = p.x - p.y + sb.di;   b.da = p.x - p.y + sb.da;
+    b.si = p.x + p.y + sb.si;   b.sa = p.x + p.y + sb.sa;
+}
 
-    if (numsub > 0)
+// Refresh the box of a slot which has moved, and of the slots attached to
+// it that moved along with it.
+void SlotIndex::update(Segment *seg, Slot *slot)
+{
+    const uint32 pos = slot->index() < _posOf.size() ? _posOf[slot->index()] : ~0U;
+    if (pos != ~0U)
     {
-        for (int i = 0; i < numsub; ++i)
+        uint32 i = _entryOf[pos];
+        Entry e = _entries[i];
+        place(seg, slot, e);
+        // Slide the entry along to where its new left edge belongs.
+        for (; i > 0 && _entries[i-1].box.xi > e.box.xi; --i)
         {
-            const BBox &sbb = gc.getSubBoundingBBox(gid, i);
-            const SlantBox &ssb = gc.getSubBoundingSlantBox(gid, i);
-            if (sy + sbb.yi - margin > y + width / 2 || sy + sbb.ya + margin < y - width / 2)
-                continue;
-            if (isRight)
-            {
-                float x = sx + sbb.xa + margin;
-                if (x > res)
-                {
-                    float td = sx - sy + ssb.da + margin + y;
-                    float ts = sx + sy + ssb.sa + margin - y;
-                    x = localmax(td - width / 2, td + width / 2,  ts - width / 2, ts + width / 2, x);
-                    if (x > res)
-                        res = x;
-                }
-            }
-            else
+            _entries[i] = _entries[i-1];
+            _entryOf[_entries[i].pos] = i;
+        }
+        for (; i + 1 < _entries.size() && _entries[i+1].box.xi < e.box.xi; ++i)
+        {
+            _entries[i] = _entries[i+1];
+            _entryOf[_entries[i].pos] = i;
+        }
+        _entries[i] = e;
+        _entryOf[pos] = i;
+    }
+    for (Slot *c = slot->firstChild(); c; c = c->nextSibling())
+        update(seg, c);
+}
+
+// Pick out the slots whose octaboxes meet any of the regions, along with
+// keep and, if given, everything attached to cluster.  The tests are written
+// so a NaN bound lets everything through.
+void SlotIndex::select(const OctaBounds regions[4], const Slot *keep, const Slot *cluster)
+{
+    _marks.assign(_always.begin(), _always.end());
+    float left = regions[0].xi, right = regions[0].xa;
+    for (int i = 1; i < 4; ++i)
+    {
+        left = min(left, regions[i].xi);
+        right = max(right, regions[i].xa);
+    }
+    left -= _maxWidth;
+    const Entry *e = _entries.begin(), *const e_end = _entries.end();
+    for (size_t n = _entries.size(); n;)
+    {
+        const size_t h = n >> 1;
+        if (e[h].box.xi < left) { e += h + 1; n -= h + 1; }
+        else n = h;
+    }
+    for (; e != e_end && !(e->box.xi > right); ++e)
+        for (const OctaBounds *r = regions; r != regions + 4; ++r)
+            if (e->box.meets(*r))
             {
-                float x = sx + sbb.xi - margin;
-                if (x < res)
-                {
-                    float td = sx - sy + ssb.di - margin + y;
-                    float ts = sx + sy + ssb.si - margin - y;
-                    x = localmin(td - width / 2, td + width / 2, ts - width / 2, ts + width / 2, x);
-                    if (x < res)
-                        res = x;
-                }
+                _marks[e->pos >> 5] |= 1U << (e->pos & 31);
+                break;
             }
-        }
+    mark(keep);
+    if (cluster)
+        markChildren(cluster);
+}
+
+void SlotIndex::mark(const Slot *slot)
+{
+    const uint32 pos = slot->index() < _posOf.size() ? _posOf[slot->index()] : ~0U;
+    if (pos != ~0U)
+        _marks[pos >> 5] |= 1U << (pos & 31);
+}
+
+void SlotIndex::markChildren(const Slot *slot)
+{
+    for (const Slot *c = slot->firstChild(); c; c = c->nextSibling())
+    {
+        mark(c);
+        markChildren(c);
+    }
+}
+
+// The next selected slot after slot in range order, walking backwards no
+// further than a backward walk from the end of the range would go.
+Slot *SlotIndex::next(const Slot *slot, bool isRev) const
+{
+    uint32 pos = _posOf[slot->index()];
+    if (isRev)
+    {
+        while (pos-- > _revStop)
+            if (_marks[pos >> 5] & (1U << (pos & 31)))
+                return _slots[pos];
     }
     else
     {
-        const BBox &bb = gc.getBoundingBBox(gid);
-        const SlantBox &sb = gc.getBoundingSlantBox(gid);
-        if (sy + bb.yi - margin > y + width / 2 || sy + bb.ya + margin < y - width / 2)
-            return res;
-        float td = sx - sy + y;
-        float ts = sx + sy - y;
-        if (isRight)
-            res = localmax(td + sb.da - width / 2, td + sb.da + width / 2, ts + sb.sa - width / 2, ts + sb.sa + width / 2, sx + bb.xa) + margin;
-        else
-            res = localmin(td + sb.di - width / 2, td + sb.di + width / 2, ts + sb.si - width / 2, ts + sb.si + width / 2, sx + bb.xi) - margin;
+        while (++pos < _slots.size())
+            if (_marks[pos >> 5] & (1U << (pos & 31)))
+                return _slots[pos];
     }
-    return res;
+    return 0;
+}
+
+
+////    KERN-COLLIDER    ////
+
+// Work out the given edge of the glyph in each of the slices p asks for,
+// taking any slant boxes into account.
+static void get_edges(const SliceEdges::Kernel &kernel, const CollisionGeometry &geom, const Slot *s,
+                      const SliceEdges::Params &p, float *res)
+{
+    unsigned short gid = s->gid();
+    uint8 numsub = geom.numSubs(gid);
+
+    if (numsub > 0)
+    {
+        const CollisionBox * const subs = geom.subs(gid);
+        SliceEdges::reset(p, res);
+        for (int i = 0; i < numsub; ++i)
+            kernel.sub(p, subs[i].bb, subs[i].sb, res);
+    }
+    else
+        kernel.whole(p, geom.box(gid).bb, geom.box(gid).sb, res);
+}
+
+// Return the edge in slice i, working out a batch of them from there up to
+// slice last whenever i is past the ones held in res.
+static inline float slice_edge(const SliceEdges::Kernel &kernel, const CollisionGeometry &geom, const Slot *s,
+                               SliceEdges::Params &p, float *res, int i, int last)
+{
+    if (i >= p.first + p.count)
+    {
+        p.first = i;
+        p.count = min(last - i + 1, int(SliceEdges::MAX_SLICES));
+        get_edges(kernel, geom, s, p, res);
+    }
+    return res[i - p.first];
 }
 
 
@@ -801,7 +1001,10 @@ bool KernCollider::initSlot(Segment *seg, Slot *aSlot, const Rect &limit, float
     const Position &currShift, const Position &offsetPrev, int dir,
     float ymin, float ymax, GR_MAYBE_UNUSED json * const dbgout)
 {
-    const GlyphCache &gc = seg->getFace()->glyphs();
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
+    const SliceEdges::Kernel &kernel = SliceEdges::best();
+    SliceEdges::Params p;
+    float edges[SliceEdges::MAX_SLICES];
     const Slot *base = aSlot;
     // const Slot *last = aSlot;
     const Slot *s;
@@ -866,25 +1069,32 @@ bool KernCollider::initSlot(Segment *seg, Slot *aSlot, const Rect &limit, float
 #endif
 
     // Determine the trailing edge of each slice (ie, left edge for a RTL glyph).
+    p.base = _miny - 1;
+    p.width = _sliceWidth;
+    p.margin = margin;
+    p.right = !(dir & 1);
     for (s = base; s; s = s->nextInCluster(s))
     {
         SlotCollision *c = seg->collisionInfo(s);
-        if (!gc.check(s->gid()))
+        if (!geom || !geom->check(s->gid()))
             return false;
-        const BBox &bs = gc.getBoundingBBox(s->gid());
+        const BBox &bs = geom->box(s->gid()).bb;
         float x = s->origin().x + c->shift().x + ((dir & 1) ? bs.xi : bs.xa);
         // Loop over slices.
         // Note smin might not be zero if glyph s is not at the bottom of the cluster; similarly for smax.
         float toffset = c->shift().y - _miny + 1 + s->origin().y;
         int smin = max(0, int((bs.yi + toffset) / _sliceWidth));
         int smax = min(numSlices - 1, int((bs.ya + toffset) / _sliceWidth + 1));
+        p.sx = s->origin().x + c->shift().x;
+        p.sy = s->origin().y + c->shift().y;
+        p.first = smin;
+        p.count = 0;
         for (int i = smin; i <= smax; ++i)
         {
             float t;
-            float y = _miny - 1 + (i + .5f) * _sliceWidth; // vertical center of slice
             if ((dir & 1) && x < _edges[i])
             {
-                t = get_edge(seg, s, c->shift(), y, _sliceWidth, margin, false);
+                t = slice_edge(kernel, *geom, s, p, edges, i, smax);
                 if (t < _edges[i])
                 {
                     _edges[i] = t;
@@ -894,7 +1104,7 @@ bool KernCollider::initSlot(Segment *seg, Slot *aSlot, const Rect &limit, float
             }
             else if (!(dir & 1) && x > _edges[i])
             {
-                t = get_edge(seg, s, c->shift(), y, _sliceWidth, margin, true);
+                t = slice_edge(kernel, *geom, s, p, edges, i, smax);
                 if (t > _edges[i])
                 {
                     _edges[i] = t;
@@ -920,22 +1130,33 @@ bool KernCollider::initSlot(Segment *seg, Slot *aSlot, const Rect &limit, float
 bool KernCollider::mergeSlot(Segment *seg, Slot *slot, const Position &currShift, float currSpace, int dir, GR_MAYBE_UNUSED json * const dbgout)
 {
     int rtl = (dir & 1) * 2 - 1;
-    if (!seg->getFace()->glyphs().check(slot->gid()))
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
+    if (!geom || !geom->check(slot->gid()))
         return false;
-    const Rect &bb = seg->theGlyphBBoxTemporary(slot->gid());
+    const BBox &bb = geom->box(slot->gid()).bb;
     const float sx = slot->origin().x + currShift.x;
-    float x = (sx + (rtl > 0 ? bb.tr.x : bb.bl.x)) * rtl;
+    float x = (sx + (rtl > 0 ? bb.xa : bb.xi)) * rtl;
     // this isn't going to reduce _mingap so skip
     if (_hit && x < rtl * (_xbound - _mingap - currSpace))
         return false;
 
     const float sy = slot->origin().y + currShift.y;
-    int smin = max(1, int((bb.bl.y + (1 - _miny + sy)) / _sliceWidth + 1)) - 1;
-    int smax = min((int)_edges.size() - 2, int((bb.tr.y + (1 - _miny + sy)) / _sliceWidth + 1)) + 1;
+    int smin = max(1, int((bb.yi + (1 - _miny + sy)) / _sliceWidth + 1)) - 1;
+    int smax = min((int)_edges.size() - 2, int((bb.ya + (1 - _miny + sy)) / _sliceWidth + 1)) + 1;
     if (smin > smax)
         return false;
     bool collides = false;
     bool nooverlap = true;
+    SliceEdges::Params p;
+    float edges[SliceEdges::MAX_SLICES];
+    p.sx = sx;
+    p.sy = sy;
+    p.base = _miny - 1;
+    p.width = _sliceWidth;
+    p.margin = 0.f;
+    p.first = smin;
+    p.count = 0;
+    p.right = rtl > 0;
 
     for (int i = smin; i <= smax; ++i)
     {
@@ -944,9 +1165,8 @@ bool KernCollider::mergeSlot(Segment *seg, Slot *slot, const Position &currShift
             continue;
         if (!_hit || x > here - _mingap - currSpace)
         {
-            float y = (float)(_miny - 1 + (i + .5f) * _sliceWidth);  // vertical center of slice
             // 2 * currSpace to account for the space that is already separating them and the space we want to add
-            float m = get_edge(seg, slot, currShift, y, _sliceWidth, 0., rtl > 0) * rtl + 2 * currSpace;
+            float m = slice_edge(SliceEdges::best(), *geom, slot, p, edges, i, smax) * rtl + 2 * currSpace;
             if (m < (float)-8e37)       // only true if the glyph has a gap in it
                 continue;
             nooverlap = false;
@@ -35,6 +35,9 @@ Face::Face(const void* appFaceHandle/*non-NULL*/, const gr_face_ops & ops)
   m_pNames(NULL),
   m_logger(NULL),
   m_error(0), m_errcntxt(0),
+  m_collBudget(0),
+  m_collTrips(0),
+  m_coverage(NULL),
   m_silfs(NULL),
   m_numSilf(0),
   m_ascent(0),
@@ -50,6 +53,7 @@ Face::~Face()
     setLogger(0);
     delete m_pGlyphFaceCache;
     delete m_cmap;
+    delete m_coverage.load(std::memory_order_relaxed);
     delete[] m_silfs;
 #ifndef GRAPHITE2_NFILEFACE
     delete m_pFileFace;
@@ -57,13 +61,6 @@ Face::~Face()
     delete m_pNames;
 }
 
-float Face::default_glyph_advance(const void* font_ptr, gr_uint16 glyphid)
-{
-    const Font & font = *reinterpret_cast<const Font *>(font_ptr);
-
-    return font.face().glyphs().glyph(glyphid)->theAdvance().x * font.scale();
-}
-
 bool Face::readGlyphs(uint32 faceOptions)
 {
     Error e;
@@ -82,6 +79,8 @@ bool Face::readGlyphs(uint32 faceOptions)
 
     if (faceOptions & gr_face_cacheCmap)
         m_cmap = new CachedCmap(*this);
+    else if (faceOptions & gr_face_nativeCmap)
+        m_cmap = new NativeCmap(*this);
     else
         m_cmap = new DirectCmap(*this);
     if (e.test(!m_cmap, E_OUTOFMEM) || e.test(!*m_cmap, E_BADCMAP))
@@ -154,9 +153,10 @@ bool Face::runGraphite(Segment *seg, const Silf *aSilf) const
     if ((seg->dir() & 3) == 3 && aSilf->bidiPass() == 0xFF)
         seg->doMirror(aSilf->aMirror());
     bool res = aSilf->runGraphite(seg, 0, aSilf->positionPass(), true);
+    if (res)
+        res = seg->associateChars(0, seg->charInfoCount());
     if (res)
     {
-        seg->associateChars(0, seg->charInfoCount());
         if (aSilf->flags() & 0x20)
             res &= seg->initCollisions();
         if (res)
@@ -204,6 +204,41 @@ const Silf *Face::chooseSilf(uint32 script) const
         return m_silfs;
 }
 
+bool Face::enableProfile()
+{
+    for (Silf * s = m_silfs, * const se = s + m_numSilf; s != se; ++s)
+        if (!s->enableProfile()) return false;
+    return true;
+}
+
+const gr_profile_counts * Face::getProfile(unsigned int silf, unsigned int pass, int rule, int & numRules) const
+{
+    const Pass * const p = silf < m_numSilf && pass < 256 ? m_silfs[silf].pass(uint8(pass)) : 0;
+    if (!p) return 0;
+    numRules = p->numRules();
+    return p->getProfile(rule);
+}
+
+// Other threads may ask for the coverage at the same time, so whichever of
+// them loses the race to hang its copy on the face throws that away.
+const Coverage * Face::coverage() const
+{
+    Coverage * c = m_coverage.load(std::memory_order_acquire);
+    if (c) return c;
+
+    c = new Coverage(*this);
+    if (!c || !*c)
+    {
+        delete c;
+        return 0;
+    }
+    Coverage * made = 0;
+    if (m_coverage.compare_exchange_strong(made, c, std::memory_order_acq_rel))
+        return c;
+    delete c;
+    return made;
+}
+
 uint16 Face::findPseudo(uint32 uid) const
 {
     return (m_numSilf) ? m_silfs[0].findPseudo(uid) : 0;
@@ -217,7 +217,7 @@ bool SillMap::readSill(const Face & face)
 }
 
 
-Features* SillMap::cloneFeatures(uint32 langname/*0 means default*/) const
+const Features & SillMap::features(uint32 langname/*0 means default*/) const
 {
     if (langname)
     {
@@ -226,10 +226,15 @@ Features* SillMap::cloneFeatures(uint32 langname/*0 means default*/) const
         for (uint16 i = 0; i < m_numLanguages; i++)
         {
             if (m_langFeats[i].m_lang == langname)
-                return new Features(*m_langFeats[i].m_pFeatures);
+                return *m_langFeats[i].m_pFeatures;
         }
     }
-    return new Features (m_FeatureMap.m_defaultFeatures);
+    return m_FeatureMap.m_defaultFeatures;
+}
+
+Features* SillMap::cloneFeatures(uint32 langname/*0 means default*/) const
+{
+    return new Features(features(langname));
 }
 
 
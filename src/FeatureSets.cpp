@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+
+#include "inc/FeatureSets.h"
+
+using namespace graphite2;
+
+FeatureSets::FeatureSets() throw()
+{
+    for (std::atomic<Set *> * s = m_sets; s != m_sets + MAX_SETS; ++s)
+        s->store(0, std::memory_order_relaxed);
+}
+
+FeatureSets::~FeatureSets() throw()
+{
+    for (std::atomic<Set *> * s = m_sets; s != m_sets + MAX_SETS; ++s)
+        delete s->load(std::memory_order_relaxed);
+}
+
+// Any set that loses a race for a place is thrown away, and the winner
+// compared with it like any other.
+const Features * FeatureSets::intern(const Features & feats) const throw()
+{
+    const uint32 hash = feats.hash();
+    Set * mine = 0;
+
+    for (size_t n = 0, i = hash % MAX_SETS; n != MAX_PROBES; ++n, i = (i + 1) % MAX_SETS)
+    {
+        Set * s = m_sets[i].load(std::memory_order_acquire);
+        if (!s)
+        {
+            if (!mine && !(mine = new Set(feats, hash))) return 0;
+            if (m_sets[i].compare_exchange_strong(s, mine, std::memory_order_acq_rel))
+                return &mine->feats;
+        }
+        if (s->hash == hash && s->feats == feats)
+        {
+            delete mine;
+            return &s->feats;
+        }
+    }
+    delete mine;
+    return 0;
+}
@@ -11,14 +11,14 @@ Font::Font(float ppm, const Face & f, const void * appFontHandle, const gr_font_
 : m_appFontHandle(appFontHandle ? appFontHandle : this),
   m_face(f),
   m_scale(ppm / f.glyphs().unitsPerEm()),
-  m_hinted(appFontHandle && ops && (ops->glyph_advance_x || ops->glyph_advance_y))
+  m_hinted(appFontHandle && ops && (ops->glyph_advance_x || ops->glyph_advance_y
+                                    || (ops->size > offsetof(gr_font_ops, glyph_advances_x) && ops->glyph_advances_x)))
 {
     memset(&m_ops, 0, sizeof m_ops);
-    if (m_hinted && ops)
-        memcpy(&m_ops, ops, min(sizeof m_ops, ops->size));
-    else
-        m_ops.glyph_advance_x = &Face::default_glyph_advance;
+    m_advances = 0;
+    if (!m_hinted) return;
 
+    memcpy(&m_ops, ops, min(sizeof m_ops, ops->size));
     size_t nGlyphs = f.glyphs().numGlyphs();
     m_advances = gralloc<float>(nGlyphs);
     if (m_advances)
@@ -33,3 +33,40 @@ Font::Font(float ppm, const Face & f, const void * appFontHandle, const gr_font_
 {
     free(m_advances);
 }
+
+// Asks for the advances of those of the glyphs not seen before in a single
+// call, each just once however often it comes up.  Should there be no memory
+// for the list they are left for advance() to ask for one at a time.
+void Font::prefetchAdvances(const uint16 * glyphids, size_t n) const
+{
+    if (!m_advances || !m_ops.glyph_advances_x || !n) return;
+
+    const uint16 numGlyphs = m_face.glyphs().numGlyphs();
+    uint16 * const wanted = gralloc<uint16>(n);
+    float * const advances = gralloc<float>(n);
+    size_t numWanted = 0;
+    if (wanted && advances)
+    {
+        for (const uint16 * g = glyphids, * const ge = glyphids + n; g != ge; ++g)
+        {
+            if (*g < numGlyphs && m_advances[*g] == INVALID_ADVANCE)
+            {
+                m_advances[*g] = 0;
+                wanted[numWanted++] = *g;
+            }
+        }
+        if (numWanted)
+            (*m_ops.glyph_advances_x)(m_appFontHandle, wanted, numWanted, advances);
+        for (size_t i = 0; i != numWanted; ++i)
+            m_advances[wanted[i]] = advances[i];
+    }
+    free(wanted);
+    free(advances);
+}
+
+float Font::batchedAdvance(uint16 glyphid) const
+{
+    float adv = 0;
+    (*m_ops.glyph_advances_x)(m_appFontHandle, &glyphid, 1, &adv);
+    return adv;
+}
@@ -99,7 +99,8 @@ GlyphCache::GlyphCache(const Face & face, const uint32 face_options)
         ? grzeroalloc<GlyphBox *>(_glyph_loader->num_glyphs()) : 0),
   _num_glyphs(_glyphs ? _glyph_loader->num_glyphs() : 0),
   _num_attrs(_glyphs ? _glyph_loader->num_attrs() : 0),
-  _upem(_glyphs ? _glyph_loader->units_per_em() : 0)
+  _upem(_glyphs ? _glyph_loader->units_per_em() : 0),
+  _collision_geometry(0)
 {
     if ((face_options & gr_face_preloadGlyphs) && _glyph_loader && _glyphs)
     {
@@ -163,6 +164,7 @@ GlyphCache::GlyphCache(const Face & face, const uint32 face_options)
 
 GlyphCache::~GlyphCache()
 {
+    delete _collision_geometry.load(std::memory_order_relaxed);
     if (_glyphs)
     {
         if (_glyph_loader)
@@ -190,6 +192,31 @@ GlyphCache::~GlyphCache()
     delete _glyph_loader;
 }
 
+const CollisionGeometry * GlyphCache::collisionGeometry() const
+{
+    CollisionGeometry * g = _collision_geometry.load(std::memory_order_acquire);
+    if (g || !_boxes)
+        return g;
+
+    g = new CollisionGeometry(*this);
+    if (g && !*g)
+    {
+        delete g;
+        return 0;
+    }
+    // Segments made concurrently on a preloaded face may race to build it,
+    // in which case the first one published is used by all.
+    CollisionGeometry * published = 0;
+    if (g && !_collision_geometry.compare_exchange_strong(published, g,
+                                                          std::memory_order_acq_rel,
+                                                          std::memory_order_acquire))
+    {
+        delete g;
+        g = published;
+    }
+    return g;
+}
+
 const GlyphFace *GlyphCache::glyph(unsigned short glyphid) const      //result may be changed by subsequent call with a different glyphid
 {
     if (glyphid >= numGlyphs())
@@ -218,6 +245,16 @@ const GlyphFace *GlyphCache::glyph(unsigned short glyphid) const      //result m
     return p;
 }
 
+// How many glyphs have been read in so far.
+unsigned short GlyphCache::numLoaded() const
+{
+    if (!_glyphs || preloaded()) return _glyphs ? _num_glyphs : 0;
+    unsigned short n = 0;
+    for (const GlyphFace * const * g = _glyphs, * const * const ge = g + _num_glyphs; g != ge; ++g)
+        n += *g != 0;
+    return n;
+}
+
 
 
 GlyphCache::Loader::Loader(const Face & face)
@@ -467,3 +504,68 @@ GlyphBox * GlyphCache::Loader::read_box(uint16 gid, GlyphBox *curr, const GlyphF
     }
     return (GlyphBox *)((char *)(curr) + sizeof(GlyphBox) + 2 * num * sizeof(Rect));
 }
+
+
+CollisionGeometry::CollisionGeometry(const GlyphCache & gc)
+: _lazy(gc.preloaded() ? 0 : &gc),
+  _block(0), _boxes(0), _subs(0), _first(0), _filled(0), _num_glyphs(gc.numGlyphs())
+{
+    if (_lazy)
+    {
+        const size_t words = (_num_glyphs + 31) >> 5;
+        _block = gralloc<byte>(_num_glyphs * sizeof(CollisionBox) + words * sizeof(uint32) + ALIGN - 1);
+        if (!_block)
+            return;
+        CollisionBox * boxes = reinterpret_cast<CollisionBox *>(
+                                    (reinterpret_cast<uintptr>(_block) + ALIGN - 1) & ~uintptr(ALIGN - 1));
+        _filled = reinterpret_cast<uint32 *>(boxes + _num_glyphs);
+        memset(_filled, 0, words * sizeof(uint32));
+        _boxes = boxes;
+        return;
+    }
+
+    size_t numsubs = 0;
+    for (uint16 gid = 0; gid != _num_glyphs; ++gid)
+        numsubs += gc.numSubBounds(gid);
+
+    const size_t bytes = (_num_glyphs + numsubs) * sizeof(CollisionBox)
+                       + (_num_glyphs + 1) * sizeof(uint32) + ALIGN - 1;
+    _block = gralloc<byte>(bytes);
+    if (!_block)
+        return;
+
+    CollisionBox * boxes = reinterpret_cast<CollisionBox *>(
+                                (reinterpret_cast<uintptr>(_block) + ALIGN - 1) & ~uintptr(ALIGN - 1));
+    _subs = boxes + _num_glyphs;
+    _first = reinterpret_cast<uint32 *>(_subs + numsubs);
+
+    uint32 n = 0;
+    for (uint16 gid = 0; gid != _num_glyphs; ++gid)
+    {
+        boxes[gid].bb = gc.getBoundingBBox(gid);
+        boxes[gid].sb = gc.getBoundingSlantBox(gid);
+        _first[gid] = n;
+        for (uint8 i = 0, num = gc.numSubBounds(gid); i != num; ++i, ++n)
+        {
+            _subs[n].bb = gc.getSubBoundingBBox(gid, i);
+            _subs[n].sb = gc.getSubBoundingSlantBox(gid, i);
+        }
+    }
+    _first[_num_glyphs] = n;
+    _boxes = boxes;
+}
+
+// Reads in a glyph, and with it its boxes, on a face that is not preloaded.
+// Like the glyph cache itself this is not safe to do from several threads.
+void CollisionGeometry::load(uint16 gid) const
+{
+    _lazy->glyph(gid);
+    _boxes[gid].bb = _lazy->getBoundingBBox(gid);
+    _boxes[gid].sb = _lazy->getBoundingSlantBox(gid);
+    _filled[gid >> 5] |= 1U << (gid & 31);
+}
+
+CollisionGeometry::~CollisionGeometry() throw()
+{
+    free(_block);
+}
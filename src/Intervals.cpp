@@ -75,7 +75,11 @@ void Zones::insert(Exclusion e)
     {
         const uint8 oca = e.outcode(i->x),
                     ocb = e.outcode(i->xm);
-        if ((oca & ocb) != 0) continue;
+        if ((oca & ocb) != 0)
+        {
+            if (oca & 2) break;     // i, and so all after it, lies right of e
+            continue;
+        }
 
         switch (oca ^ ocb)  // What kind of overlap?
         {
@@ -131,7 +135,11 @@ void Zones::remove(float x, float xm)
     {
         const uint8 oca = i->outcode(x),
                     ocb = i->outcode(xm);
-        if ((oca & ocb) != 0)   continue;
+        if ((oca & ocb) != 0)
+        {
+            if (oca & 1) break;     // i, and so all after it, lies right of x..xm
+            continue;
+        }
 
         switch (oca ^ ocb)  // What kind of overlap?
         {
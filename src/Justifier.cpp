@@ -12,32 +12,36 @@
 
 using namespace graphite2;
 
-class JustifyTotal {
-public:
-    JustifyTotal() : m_numGlyphs(0), m_tStretch(0), m_tShrink(0), m_tStep(0), m_tWeight(0) {}
-    void accumulate(Slot *s, Segment *seg, int level);
-    int weight() const { return m_tWeight; }
-
-    CLASS_NEW_DELETE
+namespace graphite2
+{
+    // One slot's justification values at one level, read once per line so
+    // sharing out the width need not look them up again on every round.
+    struct JustifyEntry
+    {
+        Slot  * slot;
+        int     stretch, shrink, step, weight;
+    };
+}
 
-private:
-    int m_numGlyphs;
-    int m_tStretch;
-    int m_tShrink;
-    int m_tStep;
-    int m_tWeight;
-};
+float Segment::justify(Slot *pSlot, const Font *font, float width, justFlags jflags, Slot *pFirst, Slot *pLast)
+{
+    Vector<JustifyEntry> line;
+    return justify(pSlot, font, width, jflags, pFirst, pLast, line);
+}
 
-void JustifyTotal::accumulate(Slot *s, Segment *seg, int level)
+// Justifies each of a run of lines in turn, as justify would, sharing one
+// array of justification values between them.
+void Segment::justifyLines(const Slot * const * starts, size_t numLines, const Font *font, float width, justFlags jflags, float *widths)
 {
-    ++m_numGlyphs;
-    m_tStretch += s->getJustify(seg, level, 0);
-    m_tShrink += s->getJustify(seg, level, 1);
-    m_tStep += s->getJustify(seg, level, 2);
-    m_tWeight += s->getJustify(seg, level, 3);
+    Vector<JustifyEntry> line;
+    for (size_t n = 0; n != numLines; ++n)
+    {
+        const float res = justify(const_cast<Slot *>(starts[n]), font, width, jflags, NULL, NULL, line);
+        if (widths) widths[n] = res;
+    }
 }
 
-float Segment::justify(Slot *pSlot, const Font *font, float width, GR_MAYBE_UNUSED justFlags jflags, Slot *pFirst, Slot *pLast)
+float Segment::justify(Slot *pSlot, const Font *font, float width, GR_MAYBE_UNUSED justFlags jflags, Slot *pFirst, Slot *pLast, Vector<JustifyEntry> & line)
 {
     Slot *end = last();
     float currWidth = 0.0;
@@ -101,22 +105,35 @@ float Segment::justify(Slot *pSlot, const Font *font, float width, GR_MAYBE_UNUS
         ++numLevels;
     }
 
-    Vector<JustifyTotal> stats(numLevels);
+    size_t numSlots = 0;
+    for (Slot *s = pFirst; s && s != end; s = s->nextSibling())
+        ++numSlots;
+    line.resize(numSlots * numLevels);
+    JustifyEntry *entry = line.begin();
     for (Slot *s = pFirst; s && s != end; s = s->nextSibling())
     {
         float w = s->origin().x / scale + s->advance() - base;
         if (w > currWidth) currWidth = w;
-        for (int j = 0; j < numLevels; ++j)
-            stats[j].accumulate(s, this, j);
+        for (int j = 0; j < numLevels; ++j, ++entry)
+        {
+            entry->slot = s;
+            entry->stretch = s->getJustify(this, j, 0);
+            entry->shrink = s->getJustify(this, j, 1);
+            entry->step = s->getJustify(this, j, 2);
+            entry->weight = s->getJustify(this, j, 3);
+        }
         s->just(0);
     }
+    const JustifyEntry * const lineEnd = line.begin() + numSlots * numLevels;
 
     for (int i = (width < 0.0f) ? -1 : numLevels - 1; i >= 0; --i)
     {
         float diff;
         float error = 0.;
         float diffpw;
-        int tWeight = stats[i].weight();
+        int tWeight = 0;
+        for (const JustifyEntry *e = line.begin() + i; e < lineEnd; e += numLevels)
+            tWeight += e->weight;
         if (tWeight == 0) continue;
 
         do {
@@ -124,22 +141,23 @@ float Segment::justify(Slot *pSlot, const Font *font, float width, GR_MAYBE_UNUS
             diff = width - currWidth;
             diffpw = diff / tWeight;
             tWeight = 0;
-            for (Slot *s = pFirst; s && s != end; s = s->nextSibling()) // don't include final glyph
+            for (const JustifyEntry *e = line.begin() + i; e < lineEnd; e += numLevels) // don't include final glyph
             {
-                int w = s->getJustify(this, i, 3);
+                Slot * const s = e->slot;
+                int w = e->weight;
                 float pref = diffpw * w + error;
-                int step = s->getJustify(this, i, 2);
+                int step = e->step;
                 if (!step) step = 1;        // handle lazy font developers
                 if (pref > 0)
                 {
-                    float max = uint16(s->getJustify(this, i, 0));
+                    float max = uint16(e->stretch);
                     if (i == 0) max -= s->just();
                     if (pref > max) pref = max;
                     else tWeight += w;
                 }
                 else
                 {
-                    float max = uint16(s->getJustify(this, i, 1));
+                    float max = uint16(e->shrink);
                     if (i == 0) max += s->just();
                     if (-pref > max) pref = -max;
                     else tWeight += w;
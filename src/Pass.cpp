@@ -14,6 +14,8 @@
 #include "inc/Rule.h"
 #include "inc/Error.h"
 #include "inc/Collider.h"
+#include "inc/List.h"
+#include "inc/Profile.h"
 
 using namespace graphite2;
 using vm::Machine;
@@ -27,6 +29,172 @@ enum KernCollison
     reserved   = 3
 };
 
+namespace
+{
+    const uint16 NO_FILTER   = 0xFFFF,
+                 FOLD_TRUE   = 0xFFFE,
+                 FOLD_FALSE  = 0xFFFD,
+                 MAX_FILTERS = 0xFFFD;
+
+    // Collision ranges shorter than this are quicker to search end to end.
+    const size_t MIN_INDEXED_RANGE = 16;
+
+    // Partially evaluate the raw bytecode of a rule constraint for the slot at
+    // context offset ctxt, knowing only the glyph in that slot.  This fails if
+    // the result could depend on anything other than that glyph's attributes,
+    // or if the machine would not finish cleanly, so the constraint must still
+    // be run for real.  uses_glyph reports whether the glyph was looked at.
+    bool fold_constraint(const byte * bc, const byte * const bc_end, const int ctxt,
+                         const GlyphFace * const glyph, bool & result, bool & uses_glyph)
+    {
+        uses_glyph = false;
+        int32   stack[Machine::STACK_MAX];
+        size_t  top = 0;
+        int32   ret;
+
+#define need(n)     if (top < (n)) return false
+#define params(n)   if (bc + (n) > bc_end) return false
+#define push(v)     { if (top == Machine::STACK_MAX) return false; stack[top++] = (v); }
+#define tos         stack[top-1]
+#define binop(op)   need(2); { const uint32 a = stack[--top]; tos = uint32(tos) op a; }
+#define sbinop(op)  need(2); { const int32 a = stack[--top]; tos = int32(tos) op a; }
+
+        while (bc < bc_end)
+        {
+            switch (vm::opcode(*bc++))
+            {
+            case vm::NOP :      break;
+            case vm::PUSH_BYTE :    params(1); push(int8(bc[0]));                    bc += 1; break;
+            case vm::PUSH_BYTEU :   params(1); push(uint8(bc[0]));                   bc += 1; break;
+            case vm::PUSH_SHORT :   params(2); push(int16(bc[0] << 8 | bc[1]));      bc += 2; break;
+            case vm::PUSH_SHORTU :  params(2); push(uint16(bc[0] << 8 | bc[1]));     bc += 2; break;
+            case vm::PUSH_LONG :    params(4); push(int32(be::peek<uint32>(bc)));    bc += 4; break;
+            case vm::ADD :      binop(+);   break;
+            case vm::SUB :      binop(-);   break;
+            case vm::MUL :      binop(*);   break;
+            case vm::DIV :
+            {
+                need(2);
+                const int32 b = stack[--top];
+                if (b == 0 || (tos == std::numeric_limits<int32>::min() && b == -1)) return false;
+                tos /= b;
+                break;
+            }
+            case vm::MIN_ :     need(2); --top; if (stack[top] < tos) tos = stack[top]; break;
+            case vm::MAX_ :     need(2); --top; if (stack[top] > tos) tos = stack[top]; break;
+            case vm::NEG :      need(1); tos = int32(0U - uint32(tos));  break;
+            case vm::TRUNC8 :   need(1); tos = uint8(tos);   break;
+            case vm::TRUNC16 :  need(1); tos = uint16(tos);  break;
+            case vm::COND :
+                need(3);
+                top -= 2;
+                tos = tos ? stack[top] : stack[top+1];
+                break;
+            case vm::AND :      binop(&&);  break;
+            case vm::OR :       binop(||);  break;
+            case vm::NOT :      need(1); tos = !tos; break;
+            case vm::EQUAL :    binop(==);  break;
+            case vm::NOT_EQ :   binop(!=);  break;
+            case vm::LESS :     sbinop(<);  break;
+            case vm::GTR :      sbinop(>);  break;
+            case vm::LESS_EQ :  sbinop(<=); break;
+            case vm::GTR_EQ :   sbinop(>=); break;
+            case vm::BITOR :    binop(|);   break;
+            case vm::BITAND :   binop(&);   break;
+            case vm::BITNOT :   need(1); tos = ~tos; break;
+            case vm::BITSET :
+            {
+                params(4); need(1);
+                const uint16 m = be::peek<uint16>(bc),
+                             v = be::peek<uint16>(bc + 2);
+                tos = (tos & ~m) | v;
+                bc += 4;
+                break;
+            }
+            case vm::CNTXT_ITEM :
+                // Items for other slots are skipped and count as passing.
+                params(2);
+                if (int8(bc[0]) != ctxt)
+                {
+                    bc += 2 + bc[1];
+                    push(true);
+                }
+                else
+                    bc += 2;
+                break;
+            case vm::PUSH_GLYPH_ATTR_OBS :
+                params(2);
+                if (int8(bc[1]) != 0) return false;
+                uses_glyph = true;
+                push(glyph ? int32(int16(glyph->attrs()[bc[0]])) : 0);
+                bc += 2;
+                break;
+            case vm::PUSH_GLYPH_ATTR :
+                params(3);
+                if (int8(bc[2]) != 0) return false;
+                uses_glyph = true;
+                push(glyph ? int32(int16(glyph->attrs()[be::peek<uint16>(bc)])) : 0);
+                bc += 3;
+                break;
+            case vm::POP_RET :  need(1); ret = stack[--top]; goto end;
+            case vm::RET_ZERO : ret = 0; goto end;
+            case vm::RET_TRUE : ret = 1; goto end;
+            default :
+                return false;
+            }
+        }
+        ret = 0;
+
+    end:
+        // The machine only returns a value when it is the sole thing left on
+        //  the stack.
+        result = top == 0 && ret != 0;
+        return true;
+
+#undef sbinop
+#undef binop
+#undef tos
+#undef push
+#undef params
+#undef need
+    }
+
+    // Whether a pass constraint reads nothing but the features of the first
+    // slot, so that it gives the same answer for every segment shaped with
+    // one feature set.  The bytecode has already been checked by the loader.
+    bool features_only(const byte * bc, const byte * const bc_end)
+    {
+        const vm::opcode_t * const ops = Machine::getOpcodeTable();
+        while (bc < bc_end)
+        {
+            const vm::opcode opc = vm::opcode(*bc++);
+            switch (opc)
+            {
+            case vm::PUSH_FEAT :
+                if (bc + 2 > bc_end || int8(bc[1]) != 0) return false;
+                break;
+            case vm::NOP :          case vm::PUSH_BYTE :    case vm::PUSH_BYTEU :
+            case vm::PUSH_SHORT :   case vm::PUSH_SHORTU :  case vm::PUSH_LONG :
+            case vm::ADD :  case vm::SUB :  case vm::MUL :  case vm::DIV :
+            case vm::MIN_ : case vm::MAX_ : case vm::NEG :
+            case vm::TRUNC8 :       case vm::TRUNC16 :      case vm::COND :
+            case vm::AND :  case vm::OR :   case vm::NOT :
+            case vm::EQUAL :        case vm::NOT_EQ :
+            case vm::LESS : case vm::GTR :  case vm::LESS_EQ :  case vm::GTR_EQ :
+            case vm::BITOR :        case vm::BITAND :       case vm::BITNOT :
+            case vm::BITSET :
+            case vm::PUSH_PROC_STATE :      case vm::PUSH_VERSION :
+            case vm::POP_RET :      case vm::RET_ZERO :     case vm::RET_TRUE :
+                break;
+            default :
+                return false;
+            }
+            bc += ops[opc].param_sz;
+        }
+        return true;
+    }
+}
+
 Pass::Pass()
 : m_silf(0),
   m_cols(0),
@@ -34,9 +202,13 @@ Pass::Pass()
   m_ruleMap(0),
   m_startStates(0),
   m_transitions(0),
+  m_rowBase(0),
   m_states(0),
   m_codes(0),
   m_progs(0),
+  m_filters(0),
+  m_ruleFilters(0),
+  m_profile(0),
   m_numCollRuns(0),
   m_kernColls(0),
   m_iMaxLoop(0),
@@ -50,17 +222,23 @@ Pass::Pass()
   m_minPreCtxt(0),
   m_maxPreCtxt(0),
   m_colThreshold(0),
-  m_isReverseDir(false)
+  m_isReverseDir(false),
+  m_sharedCols(false),
+  m_featConstraint(false)
 {
 }
 
 Pass::~Pass()
 {
-    free(m_cols);
+    if (!m_sharedCols) free(m_cols);
     free(m_startStates);
     free(m_transitions);
+    free(m_rowBase);
     free(m_states);
     free(m_ruleMap);
+    free(m_filters);
+    free(m_ruleFilters);
+    free(m_profile);
 
     if (m_rules) delete [] m_rules;
     if (m_codes) delete [] m_codes;
@@ -174,6 +352,7 @@ bool Pass::readPass(const byte * const pass_start, size_t pass_length, size_t su
                 || e.test(m_cPConstraint.status() != Code::loaded, m_cPConstraint.status() + E_CODEFAILURE))
             return face.error(e);
         face.error_context(face.error_context() - 1);
+        m_featConstraint = features_only(pcCode, pcCode + pass_constraint_len);
     }
     if (m_numRules)
     {
@@ -278,9 +457,112 @@ bool Pass::readRules(const byte * rule_map, const size_t num_entries,
         re->rule = m_rules + rn;
     }
 
+    foldConstraints(o_constraint, rc_data, face);
     return true;
 }
 
+// Rule constraints which only test attributes of the glyph in the slot they
+// are run on have a fixed outcome per glyph.  When all the glyphs are loaded
+// up front we evaluate these once for every glyph that has an FSM column, so
+// that testConstraint can reject or accept such slots with a bit test instead
+// of running the constraint code.
+void Pass::foldConstraints(const uint16 * o_constraint, const byte * const rc_data, Face & face)
+{
+    const GlyphCache & glyphs = face.glyphs();
+    if (!glyphs.preloaded()) return;
+#ifdef GRAPHITE2_TELEMETRY
+    face.tele.rules += m_numRules;
+#endif
+
+    size_t num_slots = 0;
+    for (const Rule * r = m_rules, * const re = r + m_numRules; r != re; ++r)
+        if (*r->constraint) num_slots += r->sort;
+    if (num_slots == 0) return;
+
+    m_ruleFilters = gralloc<uint16>(num_slots);
+    if (!m_ruleFilters) return;
+
+    // Only glyphs with a column can ever be matched into a rule's slots.
+    Vector<uint16> gids;
+    for (uint16 gid = 0; gid != m_numGlyphs; ++gid)
+        if (m_cols[gid] != 0xffffU) gids.push_back(gid);
+
+    const size_t    words = (m_numGlyphs + 31) >> 5;
+    Vector<uint32>  pool,
+                    bits(words);
+    uint16        * f = m_ruleFilters;
+    const byte    * rc_end = rc_data + be::peek<uint16>(o_constraint + m_numRules);
+    for (int n = m_numRules - 1; n >= 0; --n)
+    {
+        Rule & r = m_rules[n];
+        const byte * const rc_begin = be::peek<uint16>(o_constraint + n) ? rc_data + be::peek<uint16>(o_constraint + n) : rc_end;
+        if (!*r.constraint) { rc_end = rc_begin; continue; }
+
+        bool any = false;
+        for (int k = 0; k != r.sort; ++k)
+        {
+            f[k] = NO_FILTER;
+            bool res = false, uses_glyph = false;
+            if (gids.empty() || !fold_constraint(rc_begin, rc_end, k - r.preContext,
+                                        glyphs.glyphSafe(gids[0]), res, uses_glyph))
+                continue;
+            if (!uses_glyph)
+            {
+                f[k] = res ? FOLD_TRUE : FOLD_FALSE;
+                any = true;
+                continue;
+            }
+
+            memset(bits.begin(), 0, words * sizeof(uint32));
+            bool ok = true;
+            for (const uint16 * g = gids.begin(); ok && g != gids.end(); ++g)
+            {
+                ok = fold_constraint(rc_begin, rc_end, k - r.preContext, glyphs.glyphSafe(*g), res, uses_glyph);
+                if (res) bits[*g >> 5] |= 1U << (*g & 31);
+            }
+            if (!ok) continue;
+
+            // Share bitsets between rules which test the same thing.
+            size_t i = 0;
+            while (i != pool.size() && memcmp(pool.begin() + i, bits.begin(), words * sizeof(uint32)))
+                i += words;
+            if (i == pool.size())
+            {
+                if (i / words >= MAX_FILTERS) continue;
+                pool.insert(pool.end(), bits.begin(), bits.end());
+            }
+            f[k] = uint16(i / words);
+            any = true;
+        }
+        if (any)
+        {
+#ifdef GRAPHITE2_TELEMETRY
+            int k = 0;
+            for (int i = 0; i != r.sort; ++i)
+                if (f[i] != NO_FILTER) ++k;
+            face.tele.folded_slots += k;
+            if (k == r.sort) ++face.tele.folded_rules;
+#endif
+            r.filter = f;
+            f += r.sort;
+        }
+        rc_end = rc_begin;
+    }
+
+    if (pool.size())
+        m_filters = gralloc<uint32>(pool.size());
+    if (f == m_ruleFilters || (pool.size() && !m_filters))
+    {
+        for (Rule * r = m_rules, * const re = r + m_numRules; r != re; ++r)
+            r->filter = 0;
+        free(m_ruleFilters);
+        m_ruleFilters = 0;
+        return;
+    }
+    if (m_filters)
+        memcpy(m_filters, pool.begin(), pool.size() * sizeof(uint32));
+}
+
 static int cmpRuleEntry(const void *a, const void *b) { return (*(RuleEntry *)a < *(RuleEntry *)b ? -1 :
                                                                 (*(RuleEntry *)b < *(RuleEntry *)a ? 1 : 0)); }
 
@@ -297,9 +579,8 @@ bool Pass::readStates(const byte * starts, const byte *states, const byte * o_ru
 #ifdef GRAPHITE2_TELEMETRY
     telemetry::set_category(face.tele.transitions);
 #endif
-    m_transitions      = gralloc<uint16>(m_numTransition * m_numColumns);
 
-    if (e.test(!m_startStates || !m_states || !m_transitions, E_OUTOFMEM)) return face.error(e);
+    if (e.test(!m_startStates || !m_states, E_OUTOFMEM)) return face.error(e);
     // load start states
     for (uint16 * s = m_startStates,
                 * const s_end = s + m_maxPreCtxt - m_minPreCtxt + 1; s != s_end; ++s)
@@ -312,17 +593,17 @@ bool Pass::readStates(const byte * starts, const byte *states, const byte * o_ru
         }
     }
 
-    // load state transition table.
-    for (uint16 * t = m_transitions,
-                * const t_end = t + m_numTransition*m_numColumns; t != t_end; ++t)
+    // check then load the state transition table.
+    const size_t row_len = m_numColumns * sizeof(uint16);
+    for (const byte * t = states, * const t_end = t + m_numTransition*row_len; t != t_end; t += sizeof(uint16))
     {
-        *t = be::read<uint16>(states);
-        if (e.test(*t >= m_numStates, E_BADSTATE))
+        if (e.test(be::peek<uint16>(t) >= m_numStates, E_BADSTATE))
         {
-            face.error_context((face.error_context() & 0xFFFF00) + EC_ATRANS + int(((t - m_transitions) / m_numColumns) << 8));
+            face.error_context((face.error_context() & 0xFFFF00) + EC_ATRANS + int(((t - states) / row_len) << 8));
             return face.error(e);
         }
     }
+    if (e.test(!packTransitions(states), E_OUTOFMEM)) return face.error(e);
 
     State * s = m_states,
           * const success_begin = m_states + m_numStates - m_numSuccess;
@@ -347,6 +628,184 @@ bool Pass::readStates(const byte * starts, const byte *states, const byte * o_ru
     return true;
 }
 
+namespace
+{
+    const size_t MAX_PACK_SEARCH = 32;
+
+    // The 32 bits of a bitset from bit pos on, bits past its end being clear.
+    uint32 bits_at(const Vector<uint32> & v, const size_t pos)
+    {
+        const size_t w = pos >> 5, s = pos & 31;
+        const uint32 lo = w < v.size() ? v[w] : 0;
+        if (!s) return lo;
+        const uint32 hi = w + 1 < v.size() ? v[w + 1] : 0;
+        return (lo >> s) | (hi << (32 - s));
+    }
+
+    void set_bit(Vector<uint32> & v, const size_t pos)
+    {
+        const size_t w = pos >> 5;
+        if (w >= v.size())
+        {
+            if (w >= v.capacity()) v.reserve(max(w + 1, 2 * v.capacity()));
+            v.resize(w + 1, 0);
+        }
+        v[w] |= 1U << (pos & 31);
+    }
+
+    int cmp_uint32(const void * a, const void * b)
+    {
+        const uint32 x = *static_cast<const uint32 *>(a),
+                     y = *static_cast<const uint32 *>(b);
+        return x < y ? -1 : (y < x ? 1 : 0);
+    }
+}
+
+// Row displacement compression of the dense transition table from the font.
+// Transitions to state 0 end the match so take no space: every distinct row
+// is given a base of its own at which all its other transitions land on
+// cells no other row uses, and identical rows share their base.
+bool Pass::packTransitions(const byte * states)
+{
+    if (!m_numTransition) return true;
+    const size_t row_len = m_numColumns * sizeof(uint16);
+    m_rowBase = gralloc<uint32>(m_numTransition);
+    if (!m_rowBase) return false;
+
+    // Bucket the rows by an FNV-1a hash to find the first of each kind,
+    // noting those densest first.
+    size_t mask = 1;
+    while (mask < 2u * m_numTransition) mask <<= 1;
+    Vector<uint16> buckets(mask--, 0xFFFF),
+                   first(m_numTransition);
+    Vector<uint32> order;
+    for (uint16 r = 0; r != m_numTransition; ++r)
+    {
+        const byte * const row = states + r * row_len;
+        uint32 h = 2166136261u;
+        uint16 n = 0;
+        for (const byte * t = row; t != row + row_len; t += sizeof(uint16))
+        {
+            const uint16 next = be::peek<uint16>(t);
+            h = (h ^ next) * 16777619u;
+            n += next != 0;
+        }
+        size_t b = h & mask;
+        while (buckets[b] != 0xFFFF && memcmp(row, states + buckets[b] * row_len, row_len))
+            b = (b + 1) & mask;
+        if (buckets[b] == 0xFFFF)
+        {
+            buckets[b] = r;
+            order.push_back(uint32(m_numColumns - n) << 16 | r);
+        }
+        first[r] = buckets[b];
+    }
+    qsort(order.begin(), order.size(), sizeof(uint32), &cmp_uint32);
+
+    // First fit each row, densest first, at the lowest base not already
+    // taken where its transitions only land on unused cells.  Bitsets of
+    // both let 32 candidate bases be tried at once, and only the last
+    // MAX_PACK_SEARCH words are searched: going further back costs far more
+    // load time than the few percent of cells it saves.
+    Vector<uint32>  used, taken;
+    Vector<uint16>  cols;
+    size_t          full = 0,       // words of used with no cell left
+                    len = 0;
+    for (const uint32 * o = order.begin(); o != order.end(); ++o)
+    {
+        const uint16 r = *o & 0xFFFF;
+        const byte * const row = states + r * row_len;
+        cols.clear();
+        for (uint16 c = 0; c != m_numColumns; ++c)
+            if (be::peek<uint16>(row + c * sizeof(uint16))) cols.push_back(c);
+
+        const size_t anchor = cols.empty() ? 0 : cols[0];
+        size_t w = full * 32 > anchor ? (full * 32 - anchor) >> 5 : 0;
+        if (used.size() > w + MAX_PACK_SEARCH) w = used.size() - MAX_PACK_SEARCH;
+        uint32 fit;
+        for (;; ++w)
+        {
+            fit = ~bits_at(taken, w * 32);
+            for (const uint16 * c = cols.begin(); fit && c != cols.end(); ++c)
+                fit &= ~bits_at(used, w * 32 + *c);
+            if (fit) break;
+        }
+        size_t base = w * 32;
+        for (; !(fit & 1); fit >>= 1) ++base;
+
+        len = max(len, base + m_numColumns);
+        set_bit(taken, base);
+        for (const uint16 * c = cols.begin(); c != cols.end(); ++c)
+            set_bit(used, base + *c);
+        while (full < used.size() && used[full] == 0xFFFFFFFFU) ++full;
+        m_rowBase[r] = uint32(base);
+    }
+
+    // Cells no row owns check against a base beyond them.
+    m_transitions = gralloc<Transition>(len);
+    if (!m_transitions) return false;
+    for (size_t i = 0; i != len; ++i)
+    {
+        m_transitions[i].next = 0;
+        m_transitions[i].check = uint16(i + 1);
+    }
+    for (const uint32 * o = order.begin(); o != order.end(); ++o)
+    {
+        const uint16 r = *o & 0xFFFF;
+        const byte * t = states + r * row_len;
+        for (Transition * c = m_transitions + m_rowBase[r], * const c_end = c + m_numColumns; c != c_end; ++c)
+        {
+            const uint16 next = be::read<uint16>(t);
+            if (!next) continue;
+            c->next = next;
+            c->check = uint16(m_rowBase[r]);
+        }
+    }
+    for (uint16 r = 0; r != m_numTransition; ++r)
+        m_rowBase[r] = m_rowBase[first[r]];
+    return true;
+}
+
+inline
+uint16 Pass::transition(uint16 state, uint16 col) const
+{
+    const uint32 base = m_rowBase[state];
+    const Transition & t = m_transitions[base + col];
+    return t.check == uint16(base) ? t.next : 0;
+}
+
+// Sets bit in the mask of each glyph a match can begin with, those whose
+// column leads out of some start state.
+void Pass::markStarts(uint32 * glyph_masks, size_t stride, size_t num_glyphs, uint32 bit) const
+{
+    if (!m_numRules) return;
+
+    Vector<byte> starts(m_numColumns, 0);
+    for (const uint16 * s = m_startStates,
+                * const s_end = s + m_maxPreCtxt - m_minPreCtxt + 1; s != s_end; ++s)
+    {
+        if (*s >= m_numTransition) continue;
+        for (uint16 c = 0; c != m_numColumns; ++c)
+            if (transition(*s, c)) starts[c] = 1;
+    }
+
+    num_glyphs = min(num_glyphs, size_t(m_numGlyphs));
+    for (size_t g = 0; g != num_glyphs; ++g, glyph_masks += stride)
+        if (m_cols[g] != 0xFFFFU && starts[m_cols[g]]) *glyph_masks |= bit;
+}
+
+bool Pass::shareColumns(const Pass & p)
+{
+    if (!m_cols || !p.m_cols || m_numGlyphs != p.m_numGlyphs
+            || memcmp(m_cols, p.m_cols, m_numGlyphs * sizeof(uint16)))
+        return false;
+
+    if (!m_sharedCols) free(m_cols);
+    m_cols = p.m_cols;
+    m_sharedCols = true;
+    return true;
+}
+
 bool Pass::readRanges(const byte * ranges, size_t num_ranges, Error &e)
 {
     m_cols = gralloc<uint16>(m_numGlyphs);
@@ -372,10 +831,18 @@ bool Pass::readRanges(const byte * ranges, size_t num_ranges, Error &e)
 }
 
 
-bool Pass::runGraphite(vm::Machine & m, FiniteStateMachine & fsm, bool reverse) const
+bool Pass::runGraphite(vm::Machine & m, FiniteStateMachine & fsm, bool reverse, bool check_constraint) const
 {
-    Slot *s = m.slotMap().segment.first();
-    if (!s || !testPassConstraint(m)) return true;
+    Segment & seg = m.slotMap().segment;
+    Slot *s = seg.first();
+    uint32 on[8];
+    bool partial = false;
+    if (!s) return true;
+    if (check_constraint && m_cPConstraint)
+    {
+        if (seg.numFeatures() > 1 ? !testFeatureRuns(m, on, partial) : !testPassConstraint(m))
+            return true;
+    }
     if (reverse)
     {
         m.slotMap().segment.reverseSlots();
@@ -394,8 +861,16 @@ bool Pass::runGraphite(vm::Machine & m, FiniteStateMachine & fsm, bool reverse)
         int lc = m_iMaxLoop;
         do
         {
-            findNDoRule(s, m, fsm);
-            if (m.status() != Machine::finished) return false;
+            // Rules only start in runs whose features let the pass run,
+            // though they may match on into the runs around them.
+            const int fid = partial ? seg.charinfo(s->original())->fid() : 0;
+            if (partial && !(on[fid >> 5] & (1U << (fid & 31))))
+                s = s->next();
+            else
+            {
+                findNDoRule(s, m, fsm);
+                if (m.status() != Machine::finished) return false;
+            }
             if (s && (s == m.slotMap().highwater() || m.slotMap().highpassed() || --lc == 0)) {
                 if (!lc)
                     s = m.slotMap().highwater();
@@ -445,8 +920,7 @@ bool Pass::runFSM(FiniteStateMachine& fsm, Slot * slot) const
          || state >= m_numTransition)
             return free_slots != 0;
 
-        const uint16 * transitions = m_transitions + state*m_numColumns;
-        state = transitions[m_cols[slot->gid()]];
+        state = transition(state, m_cols[slot->gid()]);
         if (state >= m_successStart)
             fsm.rules.accumulate_rules(m_states[state]);
 
@@ -480,13 +954,15 @@ Slot * output_slot(const SlotMap &  slots, const int n)
 void Pass::findNDoRule(Slot * & slot, Machine &m, FiniteStateMachine & fsm) const
 {
     assert(slot);
+    const bool timed = m_profile && m_profile->fsm_runs++ % PROFILE_SAMPLE == 0;
+    profile_timer _timer(timed ? m_profile : 0);
 
     if (runFSM(fsm, slot))
     {
         // Search for the first rule which passes the constraint
         const RuleEntry *        r = fsm.rules.begin(),
                         * const re = fsm.rules.end();
-        while (r != re && !testConstraint(*r->rule, m))
+        while (r != re && !testConstraint(*r->rule, m, timed))
         {
             ++r;
             if (m.status() != Machine::finished)
@@ -502,7 +978,8 @@ void Pass::findNDoRule(Slot * & slot, Machine &m, FiniteStateMachine & fsm) cons
                 dumpRuleEventConsidered(fsm, *r);
                 if (r != re)
                 {
-                    const int adv = doAction(r->rule->action, slot, m);
+                    profile_timer _rule_timer(timed ? ruleProfile(*r->rule) : 0);
+                    const int adv = doAction(*r->rule, slot, m);
                     dumpRuleEventOutput(fsm, *r->rule, slot);
                     if (r->rule->action->deletes()) fsm.slots.collectGarbage(slot);
                     adjustSlot(adv, slot, fsm.slots);
@@ -525,7 +1002,8 @@ void Pass::findNDoRule(Slot * & slot, Machine &m, FiniteStateMachine & fsm) cons
         {
             if (r != re)
             {
-                const int adv = doAction(r->rule->action, slot, m);
+                profile_timer _rule_timer(timed ? ruleProfile(*r->rule) : 0);
+                const int adv = doAction(*r->rule, slot, m);
                 if (m.status() != Machine::finished) return;
                 if (r->rule->action->deletes()) fsm.slots.collectGarbage(slot);
                 adjustSlot(adv, slot, fsm.slots);
@@ -590,30 +1068,131 @@ void Pass::dumpRuleEventOutput(const FiniteStateMachine & fsm, const Rule & r, S
 #endif
 
 
-inline
-bool Pass::testPassConstraint(Machine & m) const
+bool Pass::runPassConstraint(Machine & m, Slot * at) const
 {
-    if (!m_cPConstraint) return true;
-
     assert(m_cPConstraint.constraint());
 
-    m.slotMap().reset(*m.slotMap().segment.first(), 0);
-    m.slotMap().pushSlot(m.slotMap().segment.first());
+    m.slotMap().reset(*at, 0);
+    m.slotMap().pushSlot(at);
     vm::slotref * map = m.slotMap().begin();
     const uint32 ret = m_cPConstraint.run(m, map);
+    return ret && m.status() == Machine::finished;
+}
+
+bool Pass::testPassConstraint(Machine & m) const
+{
+    if (!m_cPConstraint) return true;
+
+    const bool ret = runPassConstraint(m, m.slotMap().segment.first());
 
 #if !defined GRAPHITE2_NTRACING
     json * const dbgout = m.slotMap().segment.getFace()->logger();
     if (dbgout)
-        *dbgout << "constraint" << (ret && m.status() == Machine::finished);
+        *dbgout << "constraint" << ret;
 #endif
 
-    return ret && m.status() == Machine::finished;
+    return ret;
 }
 
+// With more than one feature set in the segment the constraint is tested
+// once for each, from the first slot that has it, and on gets a bit set for
+// each set it holds for.  Returns whether it holds for any; partial is set
+// if it also fails for some.
+bool Pass::testFeatureRuns(Machine & m, uint32 * on, bool & partial) const
+{
+    Segment & seg = m.slotMap().segment;
+    uint32 seen[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    bool any = false;
+
+    memset(on, 0, 8 * sizeof(uint32));
+    partial = false;
+    for (Slot * s = seg.first(); s; s = s->next())
+    {
+        const int fid = seg.charinfo(s->original())->fid();
+        const uint32 bit = 1U << (fid & 31);
+        if (seen[fid >> 5] & bit) continue;
+        seen[fid >> 5] |= bit;
+        if (runPassConstraint(m, s))
+        {
+            on[fid >> 5] |= bit;
+            any = true;
+        }
+        else if (m.status() != Machine::finished)
+            return false;
+        else
+            partial = true;
+    }
+    partial = partial && any;
+
+#if !defined GRAPHITE2_NTRACING
+    json * const dbgout = seg.getFace()->logger();
+    if (dbgout)
+        *dbgout << "constraint" << any;
+#endif
+
+    return any;
+}
+
+
+inline
+bool Pass::glyphInFilter(uint16 filter, uint16 gid) const
+{
+    if (filter >= MAX_FILTERS) return filter == FOLD_TRUE;
+    const uint32 * const bits = m_filters + filter * ((m_numGlyphs + 31) >> 5);
+    return gid < m_numGlyphs && (bits[gid >> 5] & (1U << (gid & 31)));
+}
+
+bool Pass::enableProfile()
+{
+    if (!m_profile)
+        m_profile = grzeroalloc<gr_profile_counts>(m_numRules + 1);
+    return m_profile != 0;
+}
+
+const gr_profile_counts * Pass::getProfile(int rule) const
+{
+    if (!m_profile || rule < -1 || rule >= int(m_numRules)) return 0;
+    return m_profile + 1 + rule;
+}
+
+inline
+gr_profile_counts * Pass::ruleProfile(const Rule & r) const
+{
+    return m_profile ? m_profile + 1 + (&r - m_rules) : 0;
+}
+
+inline
+void Pass::profile(const Rule & r, size_t gr_profile_counts::* counter, size_t n) const
+{
+    if (!m_profile) return;
+    m_profile->*counter += n;
+    ruleProfile(r)->*counter += n;
+}
+
+// Runs one of r's programs, counting the instructions it executes when
+// profiling.
+inline
+int32 Pass::runCode(const Rule & r, const Code & c, Machine & m, vm::slotref * & map) const
+{
+    if (!m_profile) return c.run(m, map);
+    size_t n = 0;
+    m.countInstructions(&n);
+    const int32 ret = c.run(m, map);
+    m.countInstructions(0);
+    profile(r, &gr_profile_counts::instructions, n);
+    return ret;
+}
+
+inline
+bool Pass::testConstraint(const Rule & r, Machine & m, bool timed) const
+{
+    profile_timer _timer(timed ? ruleProfile(r) : 0);
+    return testConstraint(r, m);
+}
 
 bool Pass::testConstraint(const Rule & r, Machine & m) const
 {
+    profile(r, &gr_profile_counts::rules_considered);
     const uint16 curr_context = m.slotMap().context();
     if (unsigned(r.sort + curr_context - r.preContext) > m.slotMap().size()
         || curr_context - r.preContext < 0) return false;
@@ -624,14 +1203,26 @@ bool Pass::testConstraint(const Rule & r, Machine & m) const
 
     if (!*r.constraint) return true;
     assert(r.constraint->constraint());
+    profile(r, &gr_profile_counts::constraints_run);
+    // Folded slots never run the constraint, so check its slot references
+    //  up front as run() would have done.
+    const uint16 * filter = r.filter;
+    if (filter && !r.constraint->refsInRange(m)) return false;
     for (int n = r.sort; n && map; --n, ++map)
     {
+        const uint16 f = filter ? *filter++ : NO_FILTER;
         if (!*map) continue;
-        const int32 ret = r.constraint->run(m, map);
+        if (f != NO_FILTER)
+        {
+            if (!glyphInFilter(f, (*map)->gid())) return false;
+            continue;
+        }
+        const int32 ret = runCode(r, *r.constraint, m, map);
         if (!ret || m.status() != Machine::finished)
             return false;
     }
 
+    profile(r, &gr_profile_counts::constraints_passed);
     return true;
 }
 
@@ -651,15 +1242,17 @@ void SlotMap::collectGarbage(Slot * &aSlot)
 
 
 
-int Pass::doAction(const Code *codeptr, Slot * & slot_out, vm::Machine & m) const
+int Pass::doAction(const Rule & r, Slot * & slot_out, vm::Machine & m) const
 {
+    const Code * const codeptr = r.action;
     assert(codeptr);
     if (!*codeptr) return 0;
+    profile(r, &gr_profile_counts::actions_run);
     SlotMap   & smap = m.slotMap();
     vm::slotref * map = &smap[smap.context()];
     smap.highpassed(false);
 
-    int32 ret = codeptr->run(m, map);
+    int32 ret = runCode(r, *codeptr, m, map);
 
     if (m.status() != Machine::finished)
     {
@@ -713,10 +1306,8 @@ void Pass::adjustSlot(int delta, Slot * & slot_out, SlotMap & smap) const
 bool Pass::collisionShift(Segment *seg, int dir, json * const dbgout) const
 {
     ShiftCollider shiftcoll(dbgout);
-    // bool isfirst = true;
-    bool hasCollisions = false;
+    SlotIndex ranges, * index;
     Slot *start = seg->first();      // turn on collision fixing for the first slot
-    Slot *end = NULL;
     bool moved = false;
 
 #if !defined GRAPHITE2_NTRACING
@@ -725,115 +1316,161 @@ bool Pass::collisionShift(Segment *seg, int dir, json * const dbgout) const
             << json::flat << json::object << "num-loops" << m_numCollRuns << json::close;
 #endif
 
+    // A range runs from a slot flagged as its start up to and including the
+    // next one flagged as an end, which may itself start the following range.
+    // Ranges are resolved in order since that shared slot, and whether
+    // anything has moved, carry over from one to the next.
     while (start)
     {
-#if !defined GRAPHITE2_NTRACING
-        if (dbgout)  *dbgout << json::object << "phase" << "1" << "moves" << json::array;
-#endif
-        hasCollisions = false;
-        end = NULL;
-        // phase 1 : position shiftable glyphs, ignoring kernable glyphs
-        for (Slot *s = start; s; s = s->next())
+        size_t len = 1;
+        Slot *end = start->next();
+        for (; end; end = end->next(), ++len)
+            if (seg->collisionInfo(end)->flags() & SlotCollision::COLL_END)
+            {
+                end = end->next();
+                ++len;
+                break;
+            }
+
+        // Every glyph fixed in a range looks at its neighbours in the range,
+        // so in a long one only look at those near enough to matter.
+        index = 0;
+        if (!dbgout && len >= MIN_INDEXED_RANGE)
         {
-            const SlotCollision * c = seg->collisionInfo(s);
-            if (start && (c->flags() & (SlotCollision::COLL_FIX | SlotCollision::COLL_KERN)) == SlotCollision::COLL_FIX
-                      && !resolveCollisions(seg, s, start, shiftcoll, false, dir, moved, hasCollisions, dbgout))
-                return false;
-            if (s != start && (c->flags() & SlotCollision::COLL_END))
+            ranges.build(seg, start, end);
+            index = &ranges;
+        }
+
+        if (!collisionShiftRange(seg, start, end, dir, shiftcoll, index, moved, dbgout))
+            return false;
+
+        if (!end)
+            break;
+        start = NULL;
+        for (Slot *s = end->prev(); s; s = s->next())
+        {
+            if (seg->collisionInfo(s)->flags() & SlotCollision::COLL_START)
             {
-                end = s->next();
+                start = s;
                 break;
             }
         }
+    }
+    return true;
+}
+
+bool Pass::collisionShiftRange(Segment *seg, Slot *start, Slot *end, int dir, ShiftCollider &shiftcoll,
+                               SlotIndex *index, bool &moved, json * const dbgout) const
+{
+    bool hasCollisions = false;
 
 #if !defined GRAPHITE2_NTRACING
-        if (dbgout)
-            *dbgout << json::close << json::close; // phase-1
+    if (dbgout)  *dbgout << json::object << "phase" << "1" << "moves" << json::array;
+#endif
+    // phase 1 : position shiftable glyphs, ignoring kernable glyphs
+    for (Slot *s = start; s != end; s = s->next())
+    {
+        const SlotCollision * c = seg->collisionInfo(s);
+        if (start && (c->flags() & (SlotCollision::COLL_FIX | SlotCollision::COLL_KERN)) == SlotCollision::COLL_FIX
+                  && !resolveCollisions(seg, s, start, shiftcoll, index, false, dir, moved, hasCollisions, dbgout))
+            return false;
+    }
+
+#if !defined GRAPHITE2_NTRACING
+    if (dbgout)
+        *dbgout << json::close << json::close; // phase-1
 #endif
 
-        // phase 2 : loop until happy.
-        for (int i = 0; i < m_numCollRuns - 1; ++i)
+    // phase 2 : loop until happy, or until the segment's collision budget is
+    // spent.  Glyphs not yet refined by then keep their earlier positions.
+    bool spent = false;
+    for (int i = 0; i < m_numCollRuns - 1 && !spent; ++i)
+    {
+        if ((hasCollisions || moved) && !(spent = seg->collisionBudgetSpent()))
         {
-            if (hasCollisions || moved)
-            {
 
 #if !defined GRAPHITE2_NTRACING
-                if (dbgout)
-                    *dbgout << json::object << "phase" << "2a" << "loop" << i << "moves" << json::array;
+            if (dbgout)
+                *dbgout << json::object << "phase" << "2a" << "loop" << i << "moves" << json::array;
 #endif
-                // phase 2a : if any shiftable glyphs are in collision, iterate backwards,
-                // fixing them and ignoring other non-collided glyphs. Note that this handles ONLY
-                // glyphs that are actually in collision from phases 1 or 2b, and working backwards
-                // has the intended effect of breaking logjams.
-                if (hasCollisions)
+            // phase 2a : if any shiftable glyphs are in collision, iterate backwards,
+            // fixing them and ignoring other non-collided glyphs. Note that this handles ONLY
+            // glyphs that are actually in collision from phases 1 or 2b, and working backwards
+            // has the intended effect of breaking logjams.
+            if (hasCollisions)
+            {
+                hasCollisions = false;
+                #if 0
+                moved = true;
+                for (Slot *s = start; s != end; s = s->next())
                 {
-                    hasCollisions = false;
-                    #if 0
-                    moved = true;
-                    for (Slot *s = start; s != end; s = s->next())
-                    {
-                        SlotCollision * c = seg->collisionInfo(s);
-                        c->setShift(Position(0, 0));
-                    }
-                    #endif
-                    Slot *lend = end ? end->prev() : seg->last();
-                    Slot *lstart = start->prev();
-                    for (Slot *s = lend; s != lstart; s = s->prev())
+                    SlotCollision * c = seg->collisionInfo(s);
+                    c->setShift(Position(0, 0));
+                }
+                #endif
+                Slot *lend = end ? end->prev() : seg->last();
+                Slot *lstart = start->prev();
+                for (Slot *s = lend; s != lstart; s = s->prev())
+                {
+                    SlotCollision * c = seg->collisionInfo(s);
+                    if (start && (c->flags() & (SlotCollision::COLL_FIX | SlotCollision::COLL_KERN | SlotCollision::COLL_ISCOL))
+                                    == (SlotCollision::COLL_FIX | SlotCollision::COLL_ISCOL)) // ONLY if this glyph is still colliding
                     {
-                        SlotCollision * c = seg->collisionInfo(s);
-                        if (start && (c->flags() & (SlotCollision::COLL_FIX | SlotCollision::COLL_KERN | SlotCollision::COLL_ISCOL))
-                                        == (SlotCollision::COLL_FIX | SlotCollision::COLL_ISCOL)) // ONLY if this glyph is still colliding
-                        {
-                            if (!resolveCollisions(seg, s, lend, shiftcoll, true, dir, moved, hasCollisions, dbgout))
-                                return false;
-                            c->setFlags(c->flags() | SlotCollision::COLL_TEMPLOCK);
-                        }
+                        if ((spent = seg->collisionBudgetSpent()))
+                            break;
+                        if (!resolveCollisions(seg, s, lend, shiftcoll, index, true, dir, moved, hasCollisions, dbgout))
+                            return false;
+                        c->setFlags(c->flags() | SlotCollision::COLL_TEMPLOCK);
                     }
                 }
+            }
 
 #if !defined GRAPHITE2_NTRACING
-                if (dbgout)
-                    *dbgout << json::close << json::close // phase 2a
-                        << json::object << "phase" << "2b" << "loop" << i << "moves" << json::array;
+            if (dbgout)
+                *dbgout << json::close << json::close // phase 2a
+                    << json::object << "phase" << "2b" << "loop" << i << "moves" << json::array;
 #endif
 
-                // phase 2b : redo basic diacritic positioning pass for ALL glyphs. Each successive loop adjusts
-                // glyphs from their current adjusted position, which has the effect of gradually minimizing the
-                // resulting adjustment; ie, the final result will be gradually closer to the original location.
-                // Also it allows more flexibility in the final adjustment, since it is moving along the
-                // possible 8 vectors from successively different starting locations.
-                if (moved)
+            // phase 2b : redo basic diacritic positioning pass for ALL glyphs. Each successive loop adjusts
+            // glyphs from their current adjusted position, which has the effect of gradually minimizing the
+            // resulting adjustment; ie, the final result will be gradually closer to the original location.
+            // Also it allows more flexibility in the final adjustment, since it is moving along the
+            // possible 8 vectors from successively different starting locations.
+            if (moved)
+            {
+                moved = false;
+                for (Slot *s = start; s != end; s = s->next())
                 {
-                    moved = false;
-                    for (Slot *s = start; s != end; s = s->next())
+                    SlotCollision * c = seg->collisionInfo(s);
+                    if (start && (c->flags() & (SlotCollision::COLL_FIX | SlotCollision::COLL_TEMPLOCK
+                                                    | SlotCollision::COLL_KERN)) == SlotCollision::COLL_FIX)
                     {
-                        SlotCollision * c = seg->collisionInfo(s);
-                        if (start && (c->flags() & (SlotCollision::COLL_FIX | SlotCollision::COLL_TEMPLOCK
-                                                        | SlotCollision::COLL_KERN)) == SlotCollision::COLL_FIX
-                                  && !resolveCollisions(seg, s, start, shiftcoll, false, dir, moved, hasCollisions, dbgout))
+                        // Once the budget is spent, only unlock the rest.
+                        if (!spent && !(spent = seg->collisionBudgetSpent())
+                              && !resolveCollisions(seg, s, start, shiftcoll, index, false, dir, moved, hasCollisions, dbgout))
                             return false;
-                        else if (c->flags() & SlotCollision::COLL_TEMPLOCK)
-                            c->setFlags(c->flags() & ~SlotCollision::COLL_TEMPLOCK);
                     }
+                    else if (c->flags() & SlotCollision::COLL_TEMPLOCK)
+                        c->setFlags(c->flags() & ~SlotCollision::COLL_TEMPLOCK);
                 }
-        //      if (!hasCollisions) // no, don't leave yet because phase 2b will continue to improve things
-        //          break;
+            }
+    //      if (!hasCollisions) // no, don't leave yet because phase 2b will continue to improve things
+    //          break;
 #if !defined GRAPHITE2_NTRACING
-                if (dbgout)
-                    *dbgout << json::close << json::close; // phase 2
+            if (dbgout)
+                *dbgout << json::close << json::close; // phase 2
 #endif
-            }
         }
-        if (!end)
-            break;
-        start = NULL;
-        for (Slot *s = end->prev(); s; s = s->next())
+    }
+
+    // A budget spent in phase 2a may leave no phase 2b to unlock the glyphs
+    // it locked, so unlock them here.
+    if (spent)
+    {
+        for (Slot *s = start; s != end; s = s->next())
         {
-            if (seg->collisionInfo(s)->flags() & SlotCollision::COLL_START)
-            {
-                start = s;
-                break;
-            }
+            SlotCollision * c = seg->collisionInfo(s);
+            c->setFlags(c->flags() & ~SlotCollision::COLL_TEMPLOCK);
         }
     }
     return true;
@@ -844,7 +1481,7 @@ bool Pass::collisionKern(Segment *seg, int dir, json * const dbgout) const
     Slot *start = seg->first();
     float ymin = 1e38f;
     float ymax = -1e38f;
-    const GlyphCache &gc = seg->getFace()->glyphs();
+    const CollisionGeometry * const geom = seg->getFace()->glyphs().collisionGeometry();
 
     // phase 3 : handle kerning of clusters
 #if !defined GRAPHITE2_NTRACING
@@ -854,15 +1491,15 @@ bool Pass::collisionKern(Segment *seg, int dir, json * const dbgout) const
 
     for (Slot *s = seg->first(); s; s = s->next())
     {
-        if (!gc.check(s->gid()))
+        if (!geom || !geom->check(s->gid()))
             return false;
         const SlotCollision * c = seg->collisionInfo(s);
-        const Rect &bbox = seg->theGlyphBBoxTemporary(s->gid());
+        const BBox &bbox = geom->box(s->gid()).bb;
         float y = s->origin().y + c->shift().y;
         if (!(c->flags() & SlotCollision::COLL_ISSPACE))
         {
-            ymax = max(y + bbox.tr.y, ymax);
-            ymin = min(y + bbox.bl.y, ymin);
+            ymax = max(y + bbox.ya, ymax);
+            ymin = min(y + bbox.yi, ymin);
         }
         if (start && (c->flags() & (SlotCollision::COLL_KERN | SlotCollision::COLL_FIX))
                         == (SlotCollision::COLL_KERN | SlotCollision::COLL_FIX))
@@ -922,11 +1559,13 @@ static bool inKernCluster(Segment *seg, Slot *s)
 // Return true if everything was fixed, false if there are still collisions remaining.
 // isRev means be we are processing backwards.
 bool Pass::resolveCollisions(Segment *seg, Slot *slotFix, Slot *start,
-        ShiftCollider &coll, GR_MAYBE_UNUSED bool isRev, int dir, bool &moved, bool &hasCol,
+        ShiftCollider &coll, SlotIndex *index, GR_MAYBE_UNUSED bool isRev, int dir, bool &moved, bool &hasCol,
         json * const dbgout) const
 {
     Slot * nbor;  // neighboring slot
     SlotCollision *cFix = seg->collisionInfo(slotFix);
+    seg->countCollisionFix();
+    if (m_profile) ++m_profile->collision_fixes;
     if (!coll.initSlot(seg, slotFix, cFix->limit(), cFix->margin(), cFix->marginWt(),
             cFix->shift(), cFix->offset(), dir, dbgout))
         return false;
@@ -940,8 +1579,17 @@ bool Pass::resolveCollisions(Segment *seg, Slot *slotFix, Slot *start,
         base = base->attachedTo();
     Position zero(0., 0.);
 
+    // Only visit the neighbours close enough to matter, and those in the
+    // cluster that sequence ordering may apply to wherever they are.
+    if (index)
+    {
+        OctaBounds reach[4];
+        coll.reach(seg, reach);
+        index->select(reach, slotFix, cFix->seqClass() ? base : 0);
+    }
+
     // Look for collisions with the neighboring glyphs.
-    for (nbor = start; nbor; nbor = isRev ? nbor->prev() : nbor->next())
+    for (nbor = start; nbor; nbor = index ? index->next(nbor, isRev) : isRev ? nbor->prev() : nbor->next())
     {
         SlotCollision *cNbor = seg->collisionInfo(nbor);
         bool sameCluster = nbor->isChildOf(base);
@@ -975,11 +1623,12 @@ bool Pass::resolveCollisions(Segment *seg, Slot *slotFix, Slot *start,
             cFix->setShift(shift);
             if (slotFix->firstChild())
             {
-                Rect bbox;
                 Position here = slotFix->origin() + shift;
                 float clusterMin = here.x;
-                slotFix->firstChild()->finalise(seg, NULL, here, bbox, 0, clusterMin, rtl, false);
+                slotFix->firstChild()->finalise(seg, NULL, here, NULL, 0, clusterMin, rtl, false);
             }
+            if (index)
+                index->update(seg, slotFix);
         }
     }
     else
@@ -1016,8 +1665,8 @@ float Pass::resolveKern(Segment *seg, Slot *slotFix, GR_MAYBE_UNUSED Slot *start
     while (base->attachedTo())
         base = base->attachedTo();
     SlotCollision *cFix = seg->collisionInfo(base);
-    const GlyphCache &gc = seg->getFace()->glyphs();
-    const Rect &bbb = seg->theGlyphBBoxTemporary(slotFix->gid());
+    const CollisionGeometry &geom = *seg->getFace()->glyphs().collisionGeometry();
+    const BBox &bbb = geom.box(slotFix->gid()).bb;
     const float by = slotFix->origin().y + cFix->shift().y;
 
     if (base != slotFix)
@@ -1029,22 +1678,22 @@ float Pass::resolveKern(Segment *seg, Slot *slotFix, GR_MAYBE_UNUSED Slot *start
     bool isInit = false;
     KernCollider coll(dbgout);
 
-    ymax = max(by + bbb.tr.y, ymax);
-    ymin = min(by + bbb.bl.y, ymin);
+    ymax = max(by + bbb.ya, ymax);
+    ymin = min(by + bbb.yi, ymin);
     for (nbor = slotFix->next(); nbor; nbor = nbor->next())
     {
-        if (!gc.check(nbor->gid()))
+        if (!geom.check(nbor->gid()))
             return 0.;
-        const Rect &bb = seg->theGlyphBBoxTemporary(nbor->gid());
+        const BBox &bb = geom.box(nbor->gid()).bb;
         SlotCollision *cNbor = seg->collisionInfo(nbor);
         const float nby = nbor->origin().y + cNbor->shift().y;
         if (nbor->isChildOf(base))
         {
-            ymax = max(nby + bb.tr.y, ymax);
-            ymin = min(nby + bb.bl.y, ymin);
+            ymax = max(nby + bb.ya, ymax);
+            ymin = min(nby + bb.yi, ymin);
             continue;
         }
-        if ((bb.bl.y == 0.f && bb.tr.y == 0.f) || (cNbor->flags() & SlotCollision::COLL_ISSPACE))
+        if ((bb.yi == 0.f && bb.ya == 0.f) || (cNbor->flags() & SlotCollision::COLL_ISSPACE))
         {
             if (m_kernColls == InWord)
                 break;
@@ -4,6 +4,7 @@
 #include "inc/UtfCodec.h"
 #include <cstring>
 #include <cstdlib>
+#include <utility>
 
 #include "inc/bits.h"
 #include "inc/Segment.h"
@@ -32,10 +33,12 @@ Segment::Segment(size_t numchars, const Face* face, uint32 script, int textDir)
   m_numGlyphs(numchars),
   m_numCharinfo(numchars),
   m_defaultOriginal(0),
+  m_collFixes(0),
   m_dir(textDir),
   m_flags(((m_silf->flags() & 0x20) != 0) << 1),
   m_passBits(m_silf->aPassBits() ? -1 : 0)
 {
+    memset(m_matchPasses, 0, sizeof m_matchPasses);
     freeSlot(newSlot());
     m_bufSize = log_binary(numchars)+1;
 }
@@ -262,50 +265,176 @@ void Segment::linkClusters(Slot *s, Slot * end)
     }
 }
 
+namespace
+{
+    // Walks a segment's slots either in the order they are linked, or in the
+    // order reverseSlots would leave them without relinking any.  Reversed,
+    // each glyph that is not a non spacing mark heads a run made up of it and
+    // the marks after it.  The runs come in reverse, each still in order, and
+    // any marks at the very start stay where they are.
+    class slot_order
+    {
+    public:
+        slot_order(Segment & seg, bool reversed);
+
+        bool reversed() const { return m_lead != 0; }
+        Slot * first() const;
+        Slot * last() const;
+        Slot * next(Slot * s) const;
+        Slot * prev(Slot * s) const;
+
+    private:
+        bool mark(Slot * s) const { return m_seg.getSlotBidiClass(s) == 16; }
+        // The glyph heading the run s is in, 0 for any leading marks.
+        Slot * head(Slot * s) const { while (s && mark(s)) s = s->prev(); return s; }
+        // The last slot of the run h heads.
+        Slot * tail(Slot * h) const { while (h->next() && mark(h->next())) h = h->next(); return h; }
+
+        Segment       & m_seg;
+        Slot          * m_lead;     // the first run's head, 0 when not reversed
+    };
+
+    inline
+    slot_order::slot_order(Segment & seg, bool reversed)
+    : m_seg(seg), m_lead(0)
+    {
+        // reverseSlots leaves runs of no more than one slot, or of only
+        // marks, as they are.
+        if (reversed && seg.first() != seg.last())
+        {
+            Slot * s = seg.first();
+            while (s && mark(s)) s = s->next();
+            m_lead = s;
+        }
+    }
+
+    inline
+    Slot * slot_order::first() const
+    {
+        Slot * const s = m_seg.first();
+        return !reversed() || mark(s) ? s : head(m_seg.last());
+    }
+
+    inline
+    Slot * slot_order::last() const
+    {
+        return reversed() ? tail(m_lead) : m_seg.last();
+    }
+
+    inline
+    Slot * slot_order::next(Slot * s) const
+    {
+        Slot * const n = s->next();
+        if (!reversed() || (n && mark(n)))  return n;
+        Slot * const h = head(s);
+        if (!h)                             return head(m_seg.last());
+        return h->prev() ? head(h->prev()) : 0;
+    }
+
+    inline
+    Slot * slot_order::prev(Slot * s) const
+    {
+        if (!reversed() || mark(s)) return s->prev();
+        Slot * n = s->next();
+        while (n && mark(n)) n = n->next();
+        return n ? tail(n) : m_lead->prev();
+    }
+}
+
+// A font that can look up many advances at once is given every glyph the
+// segment will be positioned with before it starts.
+void Segment::prefetchAdvances(const Font & font) const
+{
+    uint16 * const gids = gralloc<uint16>(m_numGlyphs);
+    if (!gids) return;
+    size_t n = 0;
+    for (const Slot * s = m_first; s && n != m_numGlyphs; s = s->next())
+        gids[n++] = s->glyph();
+    font.prefetchAdvances(gids, n);
+    free(gids);
+}
+
 Position Segment::positionSlots(const Font *font, Slot * iStart, Slot * iEnd, bool isRtl, bool isFinal)
 {
     Position currpos(0., 0.);
     float clusterMin = 0.;
-    Rect bbox;
-    bool reorder = (currdir() != isRtl);
+    // Slots held in the other direction are walked as if they were reversed.
+    const slot_order order(*this, currdir() != isRtl);
 
-    if (reorder)
-    {
-        Slot *temp;
-        reverseSlots();
-        temp = iStart;
-        iStart = iEnd;
-        iEnd = temp;
-    }
-    if (!iStart)    iStart = m_first;
-    if (!iEnd)      iEnd   = m_last;
+    if (currdir() != isRtl)
+        std::swap(iStart, iEnd);
+    if (!iStart)    iStart = order.first();
+    if (!iEnd)      iEnd   = order.last();
 
     if (!iStart || !iEnd)   // only true for empty segments
         return currpos;
 
     if (isRtl)
     {
-        for (Slot * s = iEnd, * const end = iStart->prev(); s && s != end; s = s->prev())
+        for (Slot * s = iEnd, * const end = order.prev(iStart); s && s != end; s = order.prev(s))
         {
             if (s->isBase())
-                currpos = s->finalise(this, font, currpos, bbox, 0, clusterMin = currpos.x, isRtl, isFinal);
+                currpos = s->finalise(this, font, currpos, NULL, 0, clusterMin = currpos.x, isRtl, isFinal);
         }
     }
     else
     {
-        for (Slot * s = iStart, * const end = iEnd->next(); s && s != end; s = s->next())
+        for (Slot * s = iStart, * const end = order.next(iEnd); s && s != end; s = order.next(s))
         {
             if (s->isBase())
-                currpos = s->finalise(this, font, currpos, bbox, 0, clusterMin = currpos.x, isRtl, isFinal);
+                currpos = s->finalise(this, font, currpos, NULL, 0, clusterMin = currpos.x, isRtl, isFinal);
         }
     }
-    if (reorder)
-        reverseSlots();
     return currpos;
 }
 
 
-void Segment::associateChars(int offset, size_t numChars)
+namespace
+{
+    // Hands each character to the first slot offered whose range covers it,
+    // setting either its before or its after.  Skip pointers see that each
+    // character is visited just once however many ranges cover it.
+    class char_claims
+    {
+    public:
+        char_claims(CharInfo * chars, int n, bool before);
+        ~char_claims() { free(m_skip); }
+        operator bool () const { return m_skip != 0; }
+
+        void claim(int b, int a, int slot);
+
+    private:
+        // Follows skip pointers to the first character at or after j still
+        // waiting for a slot, halving the path as it goes.
+        int waiting(int j) { while (m_skip[j] != j) j = m_skip[j] = m_skip[m_skip[j]]; return j; }
+
+        CharInfo  * const m_chars;
+        const int   m_n;
+        int       * m_skip;
+        const bool  m_before;
+    };
+
+    char_claims::char_claims(CharInfo * chars, int n, bool before)
+    : m_chars(chars), m_n(n), m_skip(gralloc<int>(n + 1)), m_before(before)
+    {
+        if (m_skip)
+            for (int j = 0; j <= n; ++j) m_skip[j] = j;
+    }
+
+    void char_claims::claim(int b, int a, int slot)
+    {
+        a = min(a, m_n - 1);
+        for (int j = max(b, 0); j <= a; ++j)
+        {
+            if ((j = waiting(j)) > a) break;
+            if (m_before)   m_chars[j].before(slot);
+            else            m_chars[j].after(slot);
+            m_skip[j] = j + 1;
+        }
+    }
+}
+
+bool Segment::associateChars(int offset, size_t numChars)
 {
     int i = 0, j = 0;
     CharInfo *c, *cend;
@@ -314,18 +443,29 @@ void Segment::associateChars(int offset, size_t numChars)
         c->before(-1);
         c->after(-1);
     }
+    // Slot ranges seldom overlap by much, so a single sweep keeping each
+    // character's first and last slot as it goes nearly always does.  Should
+    // it cover each character more than a few times over, the characters
+    // are handed out afresh in time linear in the segment's length.
+    int budget = 4 * int(numChars) + 16;
     for (Slot * s = m_first; s; s->index(i++), s = s->next())
     {
         j = s->before();
         if (j < 0)  continue;
 
-        for (const int after = s->after(); j <= after; ++j)
+        const int after = s->after();
+        if ((budget -= after - j + 1) < 0)
+            break;
+        for (; j <= after; ++j)
         {
             c = charinfo(j);
             if (c->before() == -1 || i < c->before())   c->before(i);
             if (c->after() < i)                         c->after(i);
         }
     }
+    if (budget < 0 && !associateOverlapping(offset, numChars))
+        return false;
+
     for (Slot *s = m_first; s; s = s->next())
     {
         int a;
@@ -339,6 +479,34 @@ void Segment::associateChars(int offset, size_t numChars)
         ++a;
         s->before(a);
     }
+    return true;
+}
+
+// A character's before is the first slot whose range covers it and its
+// after the last, so hand them out going forwards and then backwards.
+bool Segment::associateOverlapping(int offset, size_t numChars)
+{
+    char_claims befores(m_charinfo + offset, int(numChars), true),
+                afters(m_charinfo + offset, int(numChars), false);
+    if (!befores || !afters) return false;
+
+    int i = 0;
+    for (CharInfo *c = m_charinfo + offset, *cend = c + numChars; c != cend; ++c)
+    {
+        c->before(-1);
+        c->after(-1);
+    }
+    for (Slot * s = m_first; s; s->index(i++), s = s->next())
+    {
+        if (s->before() >= 0)
+            befores.claim(s->before() - offset, s->after() - offset, i);
+    }
+    for (Slot * s = m_last; s; s = s->prev())
+    {
+        if (s->before() >= 0)
+            afters.claim(s->before() - offset, s->after() - offset, s->index());
+    }
+    return true;
 }
 
 
@@ -359,6 +527,61 @@ inline void process_utf_data(Segment & seg, const Face & face, const int fid, ut
 }
 
 
+// Reads characters up to e, or the first nul or error, into the segment,
+// returning how many there were.  On an error, error is left pointing at it.
+template <typename utf_iter>
+inline size_t read_utf_buffer(Segment & seg, const Face & face, const int fid, const void * s, const void * e, const void * & error)
+{
+    const Cmap    & cmap = face.cmap();
+    utf_iter c = s;
+    const utf_iter last = e;
+    int slotid = 0;
+
+    if (e && !c.validate(last))
+    {
+        error = last - 1;
+        return 0;
+    }
+    const typename utf_iter::codeunit_type * const base = c;
+    for (; !e || c != last; ++c, ++slotid)
+    {
+        const uint32 usv = *c;
+        if (c.error())
+        {
+            error = c;
+            break;
+        }
+        if (usv == 0) break;
+        uint16 gid = cmap[usv];
+        if (!gid)   gid = face.findPseudo(usv);
+        seg.appendSlot(slotid, usv, gid, fid, c - base);
+    }
+    return size_t(slotid);
+}
+
+// The segment must have been made with room for a character per code unit
+// to pEnd, or up to the nul if pEnd is 0.  Only those characters read are
+// kept.
+bool Segment::read_buffer(const Face *face, const Features* pFeats/*must not be NULL*/, gr_encform enc, const void* pStart, const void* pEnd, const void** pError)
+{
+    assert(face);
+    assert(pFeats);
+    if (!m_charinfo) return false;
+
+    const void * error = 0;
+    size_t n = 0;
+    switch (enc)
+    {
+    case gr_utf8:   n = read_utf_buffer<utf8::const_iterator>(*this, *face, addFeatures(*pFeats), pStart, pEnd, error); break;
+    case gr_utf16:  n = read_utf_buffer<utf16::const_iterator>(*this, *face, addFeatures(*pFeats), pStart, pEnd, error); break;
+    case gr_utf32:  n = read_utf_buffer<utf32::const_iterator>(*this, *face, addFeatures(*pFeats), pStart, pEnd, error); break;
+    default:        return false;
+    }
+    if (pError) *pError = error;
+    m_numCharinfo = m_numGlyphs = n;
+    return !error;
+}
+
 bool Segment::read_text(const Face *face, const Features* pFeats/*must not be NULL*/, gr_encform enc, const void* pStart, size_t nChars)
 {
     assert(face);
@@ -375,6 +598,49 @@ bool Segment::read_text(const Face *face, const Features* pFeats/*must not be NU
     return true;
 }
 
+// Characters refer to their feature set by a byte, so a segment can hold at
+// most 256 different ones.  Sets already held are shared, found by their
+// interned copy where the face has one.
+int Segment::addFeatures(const Features& feats)
+{
+    const Features * const key = m_face->featureSets().intern(feats);
+    for (size_t i = 0; i != m_feats.size(); ++i)
+        if (key ? m_featKeys[i] == key : m_feats[i] == feats) return int(i);
+    if (m_feats.size() > 0xFF) return -1;
+    m_feats.push_back(feats);
+    m_featKeys.push_back(key);
+    return int(m_feats.size()) - 1;
+}
+
+// Gives a run of the characters read in their own feature settings.
+bool Segment::setFeatureRun(size_t first, size_t count, const Features & feats)
+{
+    const int fid = addFeatures(feats);
+    if (fid < 0) return false;
+    if (first >= m_numCharinfo) return true;
+    const size_t last = count < m_numCharinfo - first ? first + count : m_numCharinfo;
+    for (size_t i = first; i != last; ++i)
+        m_charinfo[i].feats(fid);
+    return true;
+}
+
+// Takes glyphs the caller has already mapped from characters, one slot each,
+// so there is no text to decode and no cmap to look them up in.
+bool Segment::read_glyphs(const Face *face, const Features* pFeats/*must not be NULL*/, const uint16 *gids, const size_t *offsets, const uint32 *usvs, size_t nGlyphs)
+{
+    assert(face);
+    assert(pFeats);
+    assert(gids);
+    if (!m_charinfo) return false;
+
+    const int fid = addFeatures(*pFeats);
+    const uint16 numGlyphs = face->glyphs().numGlyphs();
+    for (size_t i = 0; i != nGlyphs; ++i)
+        appendSlot(int(i), usvs ? usvs[i] : 0, gids[i] < numGlyphs ? gids[i] : 0, fid,
+                   offsets ? offsets[i] : i);
+    return true;
+}
+
 void Segment::doMirror(uint16 aMirror)
 {
     Slot * s;
@@ -21,6 +21,8 @@ Silf::Silf() throw()
   m_classOffsets(0),
   m_classData(0),
   m_justs(0),
+  m_passStarts(0),
+  m_passCache(0),
   m_numPasses(0),
   m_numJusts(0),
   m_sPass(0),
@@ -41,7 +43,8 @@ Silf::Silf() throw()
   m_numPseudo(0),
   m_nClass(0),
   m_nLinear(0),
-  m_gEndLine(0)
+  m_gEndLine(0),
+  m_numStartGlyphs(0)
 {
     memset(&m_silfinfo, 0, sizeof m_silfinfo);
 }
@@ -58,14 +61,25 @@ void Silf::releaseBuffers() throw()
     free(m_classOffsets);
     free(m_classData);
     free(m_justs);
+    free(m_passStarts);
+    delete m_passCache;
     m_passes= 0;
     m_pseudos = 0;
     m_classOffsets = 0;
     m_classData = 0;
     m_justs = 0;
+    m_passStarts = 0;
+    m_passCache = 0;
 }
 
 
+bool Silf::enableProfile()
+{
+    for (Pass * p = m_passes, * const pe = p + m_numPasses; p != pe; ++p)
+        if (!p->enableProfile()) return false;
+    return true;
+}
+
 bool Silf::readGraphite(const byte * const silf_start, size_t lSilf, Face& face, uint32 version)
 {
     const byte * p = silf_start,
@@ -196,6 +210,36 @@ bool Silf::readGraphite(const byte * const silf_start, size_t lSilf, Face& face,
             releaseBuffers();
             return false;
         }
+        for (size_t j = 0; j < i; ++j)
+            if (m_passes[i].shareColumns(m_passes[j])) break;
+    }
+
+    // Note the passes each glyph can begin a match in, so a segment can skip
+    // any pass none of its glyphs could.
+    if (m_numPasses)
+    {
+        const size_t words = passWords();
+        m_numStartGlyphs = face.glyphs().numGlyphs();
+        m_passStarts = grzeroalloc<uint32>(m_numStartGlyphs * words);
+        if (e.test(!m_passStarts, E_OUTOFMEM))
+        {
+            releaseBuffers(); return face.error(e);
+        }
+        for (size_t i = 0; i < m_numPasses; ++i)
+            m_passes[i].markStarts(m_passStarts + (i >> 5), words, m_numStartGlyphs, 1U << (i & 31));
+    }
+
+    // Pass constraints that only test features need running once for each
+    // feature set the face is used with, rather than for every segment.
+    for (size_t i = 0; i < m_numPasses; ++i)
+    {
+        if (!m_passes[i].featureConstraint()) continue;
+        m_passCache = new PassCache();
+        if (e.test(!m_passCache, E_OUTOFMEM))
+        {
+            releaseBuffers(); return face.error(e);
+        }
+        break;
     }
 
     // fill in gr_faceinfo
@@ -331,6 +375,28 @@ uint16 Silf::getClassGlyph(uint16 cid, unsigned int index) const
 }
 
 
+const PassCache::Entry * Silf::activePasses(Segment & seg, SlotMap & map) const
+{
+    PassCache::Entry * fill;
+    const PassCache::Entry * const e = m_passCache->find(seg.featureKey(seg.first()->original()), fill);
+    if (!fill) return e;
+
+    // A machine of its own keeps a constraint that fails to run from
+    // spoiling the segment; such passes are left to be tested each time.
+    vm::Machine m(map);
+    for (size_t i = 0; i < m_numPasses; ++i)
+    {
+        if (!m_passes[i].featureConstraint()) continue;
+        const bool res = m_passes[i].testPassConstraint(m);
+        if (m.status() != vm::Machine::finished) break;
+        fill->known[i >> 5] |= 1U << (i & 31);
+        if (res) fill->active[i >> 5] |= 1U << (i & 31);
+    }
+    m_passCache->publish(fill);
+    return fill;
+}
+
+
 bool Silf::runGraphite(Segment *seg, uint8 firstPass, uint8 lastPass, int dobidi) const
 {
     assert(seg != 0);
@@ -339,6 +405,8 @@ bool Silf::runGraphite(Segment *seg, uint8 firstPass, uint8 lastPass, int dobidi
     FiniteStateMachine fsm(map, seg->getFace()->logger());
     vm::Machine        m(map);
     uint8              lbidi = m_bPass;
+    const PassCache::Entry * active = 0;
+    const Features   * active_key = 0;
 #if !defined GRAPHITE2_NTRACING
     json * const dbgout = seg->getFace()->logger();
 #endif
@@ -402,10 +470,43 @@ bool Silf::runGraphite(Segment *seg, uint8 firstPass, uint8 lastPass, int dobidi
         }
 #endif
 
+        // A pass none of the glyphs in the segment can begin a match in
+        // only matters for its collision avoidance.  Traces show every pass.
+        if (!seg->mayMatch(uint8(i)) && !m_passes[i].hasCollisions()
+#if !defined GRAPHITE2_NTRACING
+                && !dbgout
+#endif
+                )
+            continue;
+
+        // Look up whether a constraint on the features alone holds, working
+        // out every such pass for a feature set when it is first seen.  A
+        // pass that sets a feature drops the key, so later passes go uncached.
+        bool check_constraint = true;
+        if (m_passCache && m_passes[i].featureConstraint() && seg->first() && seg->numFeatures() == 1
+#if !defined GRAPHITE2_NTRACING
+                && !dbgout
+#endif
+                )
+        {
+            const Features * const key = seg->featureKey(seg->first()->original());
+            if (key != active_key)
+            {
+                active = key ? activePasses(*seg, map) : 0;
+                active_key = key;
+            }
+            const uint32 bit = 1U << (i & 31);
+            if (active && (active->known[i >> 5] & bit))
+            {
+                if (!(active->active[i >> 5] & bit)) continue;
+                check_constraint = false;
+            }
+        }
+
         // test whether to reorder, prepare for positioning
         bool reverse = (lbidi == 0xFF) && (seg->currdir() != ((m_dir & 1) ^ m_passes[i].reverseDir()));
         if ((i >= 32 || (seg->passBits() & (1 << i)) == 0 || m_passes[i].collisionLoops())
-                && !m_passes[i].runGraphite(m, fsm, reverse))
+                && !m_passes[i].runGraphite(m, fsm, reverse, check_constraint))
             return false;
         // only subsitution passes can change segment length, cached subsegments are short for their text
         if (m.status() != vm::Machine::finished
@@ -0,0 +1,384 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+
+#include <atomic>
+
+#include "inc/SliceEdges.h"
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define GRAPHITE2_SLICE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined GRAPHITE2_SLICE_SSE2 && ((defined __GNUC__ && (defined __x86_64__ || defined __i386__)) \
+                                     || defined _MSC_VER)
+#define GRAPHITE2_SLICE_AVX2
+#include <immintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#include <cpuid.h>
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace graphite2;
+
+// Each kernel has to do the same floating point operations in the same order
+// as the scalar one, so the hoisted terms below keep the grouping of the
+// expressions they came from.
+
+namespace
+{
+
+inline
+float localmax(float al, float au, float bl, float bu, float x)
+{
+    if (al < bl)
+    { if (au < bu) return au < x ? au : x; }
+    else if (au > bu) return bl < x ? bl : x;
+    return x;
+}
+
+inline
+float localmin(float al, float au, float bl, float bu, float x)
+{
+    if (bl > al)
+    { if (bu > au) return bl > x ? bl : x; }
+    else if (au > bu) return al > x ? al : x;
+    return x;
+}
+
+void whole_scalar(const SliceEdges::Params & p, const BBox & bb, const SlantBox & sb, float * res)
+{
+    const float hw = p.width / 2;
+    for (int i = 0; i < p.count; ++i)
+    {
+        const float y = p.base + (p.first + i + .5f) * p.width;
+        if (p.sy + bb.yi - p.margin > y + hw || p.sy + bb.ya + p.margin < y - hw)
+        {
+            res[i] = p.right ? (float)-1e38 : (float)1e38;
+            continue;
+        }
+        const float td = p.sx - p.sy + y;
+        const float ts = p.sx + p.sy - y;
+        if (p.right)
+            res[i] = localmax(td + sb.da - hw, td + sb.da + hw, ts + sb.sa - hw, ts + sb.sa + hw, p.sx + bb.xa) + p.margin;
+        else
+            res[i] = localmin(td + sb.di - hw, td + sb.di + hw, ts + sb.si - hw, ts + sb.si + hw, p.sx + bb.xi) - p.margin;
+    }
+}
+
+void sub_scalar(const SliceEdges::Params & p, const BBox & sbb, const SlantBox & ssb, float * res)
+{
+    const float hw = p.width / 2;
+    for (int i = 0; i < p.count; ++i)
+    {
+        const float y = p.base + (p.first + i + .5f) * p.width;
+        if (p.sy + sbb.yi - p.margin > y + hw || p.sy + sbb.ya + p.margin < y - hw)
+            continue;
+        if (p.right)
+        {
+            float x = p.sx + sbb.xa + p.margin;
+            if (x > res[i])
+            {
+                const float td = p.sx - p.sy + ssb.da + p.margin + y;
+                const float ts = p.sx + p.sy + ssb.sa + p.margin - y;
+                x = localmax(td - hw, td + hw, ts - hw, ts + hw, x);
+                if (x > res[i])
+                    res[i] = x;
+            }
+        }
+        else
+        {
+            float x = p.sx + sbb.xi - p.margin;
+            if (x < res[i])
+            {
+                const float td = p.sx - p.sy + ssb.di - p.margin + y;
+                const float ts = p.sx + p.sy + ssb.si - p.margin - y;
+                x = localmin(td - hw, td + hw, ts - hw, ts + hw, x);
+                if (x < res[i])
+                    res[i] = x;
+            }
+        }
+    }
+}
+
+#if defined GRAPHITE2_SLICE_SSE2
+
+// Picks a where m is set, else b.
+inline
+__m128 select(__m128 m, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+
+inline
+__m128 localmax(__m128 al, __m128 au, __m128 bl, __m128 bu, __m128 x)
+{
+    const __m128 t = select(_mm_cmplt_ps(au, bu), select(_mm_cmplt_ps(au, x), au, x), x),
+                 e = select(_mm_cmpgt_ps(au, bu), select(_mm_cmplt_ps(bl, x), bl, x), x);
+    return select(_mm_cmplt_ps(al, bl), t, e);
+}
+
+inline
+__m128 localmin(__m128 al, __m128 au, __m128 bl, __m128 bu, __m128 x)
+{
+    const __m128 t = select(_mm_cmpgt_ps(bu, au), select(_mm_cmpgt_ps(bl, x), bl, x), x),
+                 e = select(_mm_cmpgt_ps(au, bu), select(_mm_cmpgt_ps(al, x), al, x), x);
+    return select(_mm_cmpgt_ps(bl, al), t, e);
+}
+
+// The centres of the four slices from first + i.
+inline
+__m128 slice_y(const SliceEdges::Params & p, int i)
+{
+    const __m128 n = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(p.first + i), _mm_setr_epi32(0, 1, 2, 3)));
+    return _mm_add_ps(_mm_set1_ps(p.base), _mm_mul_ps(_mm_add_ps(n, _mm_set1_ps(.5f)), _mm_set1_ps(p.width)));
+}
+
+void whole_sse2(const SliceEdges::Params & p, const BBox & bb, const SlantBox & sb, float * res)
+{
+    const __m128 hw = _mm_set1_ps(p.width / 2),
+                 lo = _mm_set1_ps(p.sy + bb.yi - p.margin),
+                 hi = _mm_set1_ps(p.sy + bb.ya + p.margin),
+                 dif = _mm_set1_ps(p.sx - p.sy),
+                 sum = _mm_set1_ps(p.sx + p.sy),
+                 margin = _mm_set1_ps(p.margin),
+                 none = _mm_set1_ps(p.right ? (float)-1e38 : (float)1e38);
+    for (int i = 0; i < p.count; i += 4)
+    {
+        const __m128 y = slice_y(p, i),
+                     miss = _mm_or_ps(_mm_cmpgt_ps(lo, _mm_add_ps(y, hw)), _mm_cmplt_ps(hi, _mm_sub_ps(y, hw))),
+                     td = _mm_add_ps(dif, y),
+                     ts = _mm_sub_ps(sum, y);
+        __m128 r;
+        if (p.right)
+        {
+            const __m128 d = _mm_add_ps(td, _mm_set1_ps(sb.da)),
+                         s = _mm_add_ps(ts, _mm_set1_ps(sb.sa));
+            r = _mm_add_ps(localmax(_mm_sub_ps(d, hw), _mm_add_ps(d, hw), _mm_sub_ps(s, hw), _mm_add_ps(s, hw),
+                                    _mm_set1_ps(p.sx + bb.xa)), margin);
+        }
+        else
+        {
+            const __m128 d = _mm_add_ps(td, _mm_set1_ps(sb.di)),
+                         s = _mm_add_ps(ts, _mm_set1_ps(sb.si));
+            r = _mm_sub_ps(localmin(_mm_sub_ps(d, hw), _mm_add_ps(d, hw), _mm_sub_ps(s, hw), _mm_add_ps(s, hw),
+                                    _mm_set1_ps(p.sx + bb.xi)), margin);
+        }
+        _mm_storeu_ps(res + i, select(miss, none, r));
+    }
+}
+
+void sub_sse2(const SliceEdges::Params & p, const BBox & sbb, const SlantBox & ssb, float * res)
+{
+    const __m128 hw = _mm_set1_ps(p.width / 2),
+                 lo = _mm_set1_ps(p.sy + sbb.yi - p.margin),
+                 hi = _mm_set1_ps(p.sy + sbb.ya + p.margin);
+    const __m128 x = _mm_set1_ps(p.right ? p.sx + sbb.xa + p.margin : p.sx + sbb.xi - p.margin),
+                 dif = _mm_set1_ps(p.right ? p.sx - p.sy + ssb.da + p.margin : p.sx - p.sy + ssb.di - p.margin),
+                 sum = _mm_set1_ps(p.right ? p.sx + p.sy + ssb.sa + p.margin : p.sx + p.sy + ssb.si - p.margin);
+    for (int i = 0; i < p.count; i += 4)
+    {
+        const __m128 y = slice_y(p, i),
+                     miss = _mm_or_ps(_mm_cmpgt_ps(lo, _mm_add_ps(y, hw)), _mm_cmplt_ps(hi, _mm_sub_ps(y, hw))),
+                     td = _mm_add_ps(dif, y),
+                     ts = _mm_sub_ps(sum, y),
+                     cur = _mm_loadu_ps(res + i);
+        __m128 v, further;
+        if (p.right)
+        {
+            v = localmax(_mm_sub_ps(td, hw), _mm_add_ps(td, hw), _mm_sub_ps(ts, hw), _mm_add_ps(ts, hw), x);
+            further = _mm_cmpgt_ps(v, cur);
+        }
+        else
+        {
+            v = localmin(_mm_sub_ps(td, hw), _mm_add_ps(td, hw), _mm_sub_ps(ts, hw), _mm_add_ps(ts, hw), x);
+            further = _mm_cmplt_ps(v, cur);
+        }
+        _mm_storeu_ps(res + i, select(_mm_andnot_ps(miss, further), v, cur));
+    }
+}
+
+#endif
+
+#if defined GRAPHITE2_SLICE_AVX2
+
+AVX2_TARGET inline
+__m256 select(__m256 m, __m256 a, __m256 b)
+{
+    return _mm256_blendv_ps(b, a, m);
+}
+
+AVX2_TARGET inline
+__m256 localmax(__m256 al, __m256 au, __m256 bl, __m256 bu, __m256 x)
+{
+    const __m256 t = select(_mm256_cmp_ps(au, bu, _CMP_LT_OQ), select(_mm256_cmp_ps(au, x, _CMP_LT_OQ), au, x), x),
+                 e = select(_mm256_cmp_ps(au, bu, _CMP_GT_OQ), select(_mm256_cmp_ps(bl, x, _CMP_LT_OQ), bl, x), x);
+    return select(_mm256_cmp_ps(al, bl, _CMP_LT_OQ), t, e);
+}
+
+AVX2_TARGET inline
+__m256 localmin(__m256 al, __m256 au, __m256 bl, __m256 bu, __m256 x)
+{
+    const __m256 t = select(_mm256_cmp_ps(bu, au, _CMP_GT_OQ), select(_mm256_cmp_ps(bl, x, _CMP_GT_OQ), bl, x), x),
+                 e = select(_mm256_cmp_ps(au, bu, _CMP_GT_OQ), select(_mm256_cmp_ps(al, x, _CMP_GT_OQ), al, x), x);
+    return select(_mm256_cmp_ps(bl, al, _CMP_GT_OQ), t, e);
+}
+
+AVX2_TARGET inline
+__m256 slice_y8(const SliceEdges::Params & p, int i)
+{
+    const __m256 n = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(p.first + i),
+                                                         _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    return _mm256_add_ps(_mm256_set1_ps(p.base), _mm256_mul_ps(_mm256_add_ps(n, _mm256_set1_ps(.5f)), _mm256_set1_ps(p.width)));
+}
+
+AVX2_TARGET
+void whole_avx2(const SliceEdges::Params & p, const BBox & bb, const SlantBox & sb, float * res)
+{
+    const __m256 hw = _mm256_set1_ps(p.width / 2),
+                 lo = _mm256_set1_ps(p.sy + bb.yi - p.margin),
+                 hi = _mm256_set1_ps(p.sy + bb.ya + p.margin),
+                 dif = _mm256_set1_ps(p.sx - p.sy),
+                 sum = _mm256_set1_ps(p.sx + p.sy),
+                 margin = _mm256_set1_ps(p.margin),
+                 none = _mm256_set1_ps(p.right ? (float)-1e38 : (float)1e38);
+    for (int i = 0; i < p.count; i += 8)
+    {
+        const __m256 y = slice_y8(p, i),
+                     miss = _mm256_or_ps(_mm256_cmp_ps(lo, _mm256_add_ps(y, hw), _CMP_GT_OQ),
+                                         _mm256_cmp_ps(hi, _mm256_sub_ps(y, hw), _CMP_LT_OQ)),
+                     td = _mm256_add_ps(dif, y),
+                     ts = _mm256_sub_ps(sum, y);
+        __m256 r;
+        if (p.right)
+        {
+            const __m256 d = _mm256_add_ps(td, _mm256_set1_ps(sb.da)),
+                         s = _mm256_add_ps(ts, _mm256_set1_ps(sb.sa));
+            r = _mm256_add_ps(localmax(_mm256_sub_ps(d, hw), _mm256_add_ps(d, hw), _mm256_sub_ps(s, hw), _mm256_add_ps(s, hw),
+                                       _mm256_set1_ps(p.sx + bb.xa)), margin);
+        }
+        else
+        {
+            const __m256 d = _mm256_add_ps(td, _mm256_set1_ps(sb.di)),
+                         s = _mm256_add_ps(ts, _mm256_set1_ps(sb.si));
+            r = _mm256_sub_ps(localmin(_mm256_sub_ps(d, hw), _mm256_add_ps(d, hw), _mm256_sub_ps(s, hw), _mm256_add_ps(s, hw),
+                                       _mm256_set1_ps(p.sx + bb.xi)), margin);
+        }
+        _mm256_storeu_ps(res + i, select(miss, none, r));
+    }
+}
+
+AVX2_TARGET
+void sub_avx2(const SliceEdges::Params & p, const BBox & sbb, const SlantBox & ssb, float * res)
+{
+    const __m256 hw = _mm256_set1_ps(p.width / 2),
+                 lo = _mm256_set1_ps(p.sy + sbb.yi - p.margin),
+                 hi = _mm256_set1_ps(p.sy + sbb.ya + p.margin);
+    const __m256 x = _mm256_set1_ps(p.right ? p.sx + sbb.xa + p.margin : p.sx + sbb.xi - p.margin),
+                 dif = _mm256_set1_ps(p.right ? p.sx - p.sy + ssb.da + p.margin : p.sx - p.sy + ssb.di - p.margin),
+                 sum = _mm256_set1_ps(p.right ? p.sx + p.sy + ssb.sa + p.margin : p.sx + p.sy + ssb.si - p.margin);
+    for (int i = 0; i < p.count; i += 8)
+    {
+        const __m256 y = slice_y8(p, i),
+                     miss = _mm256_or_ps(_mm256_cmp_ps(lo, _mm256_add_ps(y, hw), _CMP_GT_OQ),
+                                         _mm256_cmp_ps(hi, _mm256_sub_ps(y, hw), _CMP_LT_OQ)),
+                     td = _mm256_add_ps(dif, y),
+                     ts = _mm256_sub_ps(sum, y),
+                     cur = _mm256_loadu_ps(res + i);
+        __m256 v, further;
+        if (p.right)
+        {
+            v = localmax(_mm256_sub_ps(td, hw), _mm256_add_ps(td, hw), _mm256_sub_ps(ts, hw), _mm256_add_ps(ts, hw), x);
+            further = _mm256_cmp_ps(v, cur, _CMP_GT_OQ);
+        }
+        else
+        {
+            v = localmin(_mm256_sub_ps(td, hw), _mm256_add_ps(td, hw), _mm256_sub_ps(ts, hw), _mm256_add_ps(ts, hw), x);
+            further = _mm256_cmp_ps(v, cur, _CMP_LT_OQ);
+        }
+        _mm256_storeu_ps(res + i, select(_mm256_andnot_ps(miss, further), v, cur));
+    }
+}
+
+bool has_avx2()
+{
+#if defined _MSC_VER
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    if ((r[2] & (1 << 27 | 1 << 28)) != (1 << 27 | 1 << 28)
+            || (_xgetbv(0) & 6) != 6)
+        return false;
+    __cpuidex(r, 7, 0);
+    return (r[1] & (1 << 5)) != 0;
+#else
+    unsigned int a, b, c, d;
+    if (__get_cpuid_max(0, 0) < 7 || !__get_cpuid(1, &a, &b, &c, &d)
+            || (c & (bit_OSXSAVE | bit_AVX)) != (bit_OSXSAVE | bit_AVX))
+        return false;
+    __asm__ ("xgetbv" : "=a" (a), "=d" (d) : "c" (0));
+    if ((a & 6) != 6)       // the OS saves the xmm and ymm registers
+        return false;
+    __cpuid_count(7, 0, a, b, c, d);
+    return (b & bit_AVX2) != 0;
+#endif
+}
+
+#endif
+
+const SliceEdges::Kernel kernels[SliceEdges::NUM_LEVELS] =
+{
+    { whole_scalar, sub_scalar },
+#if defined GRAPHITE2_SLICE_SSE2
+    { whole_sse2, sub_sse2 },
+#else
+    { 0, 0 },
+#endif
+#if defined GRAPHITE2_SLICE_AVX2
+    { whole_avx2, sub_avx2 },
+#else
+    { 0, 0 },
+#endif
+};
+
+// The level best() hands out, worked out on first use.
+std::atomic<int> best_level(-1);
+
+bool supported(SliceEdges::level l)
+{
+    switch (l)
+    {
+    case SliceEdges::SCALAR:    return true;
+#if defined GRAPHITE2_SLICE_SSE2
+    case SliceEdges::SSE2:      return true;
+#endif
+#if defined GRAPHITE2_SLICE_AVX2
+    case SliceEdges::AVX2:      return has_avx2();
+#endif
+    default:                    return false;
+    }
+}
+
+} // namespace
+
+
+const SliceEdges::Kernel & SliceEdges::best() throw()
+{
+    int l = best_level.load(std::memory_order_relaxed);
+    if (l < 0)
+    {
+        for (l = NUM_LEVELS - 1; l > SCALAR && !supported(level(l)); --l) {}
+        best_level.store(l, std::memory_order_relaxed);
+    }
+    return kernels[l];
+}
+
+const SliceEdges::Kernel * SliceEdges::at(level l) throw()
+{
+    return l < NUM_LEVELS && supported(l) ? &kernels[l] : 0;
+}
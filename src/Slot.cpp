@@ -62,11 +62,53 @@ void Slot::update(int /*numGrSlots*/, int numCharInfo, Position &relpos)
     m_position = m_position + relpos;
 }
 
-Position Slot::finalise(const Segment *seg, const Font *font, Position & base, Rect & bbox, uint8 attrLevel, float & clusterMin, bool rtl, bool isFinal, int depth)
+namespace
+{
+    // Attachment chains are followed no further than this, guarding against
+    // loops in a malformed tree.
+    const int MAX_ATTACH_DEPTH = 100;
+
+    // A slot waiting to be placed by Slot::finalise.  Kept plain so a stack
+    // of them costs nothing to set up.
+    struct pending
+    {
+        Slot      * slot;
+        float       x, y;   // the position it is placed from
+        int         depth;
+        bool        counts; // whether its advance counts towards the cluster's
+    };
+
+    // Stacks the next sibling of s, then its first child, so the child and
+    // everything below it are placed before the sibling.  A stack only ever
+    // holds one sibling waiting at each depth.
+    inline
+    int stack_attached(pending * stack, int top, Slot * s, const pending & p)
+    {
+        Slot * const parent = s->attachedTo();
+        Slot * const sibling = s->nextSibling();
+        Slot * const child = s->firstChild();
+        if (parent && sibling && sibling != s && sibling->attachedTo() == parent)
+        {
+            pending & q = stack[top++];
+            q.slot = sibling; q.x = p.x; q.y = p.y; q.depth = p.depth + 1; q.counts = p.counts;
+        }
+        if (child && child != s && child->attachedTo() == s)
+        {
+            pending & q = stack[top++];
+            q.slot = child; q.x = s->origin().x; q.y = s->origin().y; q.depth = p.depth + 1;
+            q.counts = p.counts && (!parent || s->advance() >= 0.5f);
+        }
+        return top;
+    }
+}
+
+// Places this slot from base, the position of whatever it is attached to or
+// the pen position for a base, and returns its own advance.
+inline
+Position Slot::place(const Segment *seg, const Font *font, const Position & base, Rect * bbox, float & clusterMin, bool rtl, bool isFinal)
 {
     SlotCollision *coll = NULL;
-    if (depth > 100 || (attrLevel && m_attLevel > attrLevel)) return Position(0, 0);
-    float scale = font ? font->scale() : 1.0f;
+    const float scale = font ? font->scale() : 1.0f;
     Position shift(m_shift.x * (rtl * -2 + 1) + m_just, m_shift.y);
     float tAdvance = m_advance.x + m_just;
     if (isFinal && (coll = seg->collisionInfo(this)))
@@ -75,10 +117,10 @@ Position Slot::finalise(const Segment *seg, const Font *font, Position & base, R
         if (!(coll->flags() & SlotCollision::COLL_KERN) || rtl)
             shift = shift + collshift;
     }
-    const GlyphFace * glyphFace = seg->getFace()->glyphs().glyphSafe(glyph());
+    // Only a hinted advance or the bounding box need the glyph itself.
+    const GlyphFace * glyphFace = font || bbox ? seg->getFace()->glyphs().glyphSafe(glyph()) : NULL;
     if (font)
     {
-        scale = font->scale();
         shift *= scale;
         if (font->isHinted() && glyphFace)
             tAdvance = (m_advance.x - glyphFace->theAdvance().x + m_just) * scale + font->advance(glyph());
@@ -102,22 +144,40 @@ Position Slot::finalise(const Segment *seg, const Font *font, Position & base, R
         if ((m_advance.x >= 0.5f || m_position.x < 0) && m_position.x < clusterMin) clusterMin = m_position.x;
     }
 
-    if (glyphFace)
+    if (bbox && glyphFace)
     {
         Rect ourBbox = glyphFace->theBBox() * scale + m_position;
-        bbox = bbox.widen(ourBbox);
+        *bbox = bbox->widen(ourBbox);
     }
+    return res;
+}
 
-    if (m_child && m_child != this && m_child->attachedTo() == this)
-    {
-        Position tRes = m_child->finalise(seg, font, m_position, bbox, attrLevel, clusterMin, rtl, isFinal, depth + 1);
-        if ((!m_parent || m_advance.x >= 0.5f) && tRes.x > res.x) res = tRes;
-    }
+// Positions this slot and everything attached below it, depth first with an
+// explicit stack, so each slot is placed after the one it hangs from.  The
+// result is the furthest advance of the slots that count towards the
+// cluster's: those whose ancestors, short of the base, all have an advance
+// of their own.  bbox, when given, is widened to take in every glyph placed.
+Position Slot::finalise(const Segment *seg, const Font *font, Position & base, Rect * bbox, uint8 attrLevel, float & clusterMin, bool rtl, bool isFinal)
+{
+    pending stack[MAX_ATTACH_DEPTH + 3];
+
+    if (attrLevel && m_attLevel > attrLevel) return Position(0, 0);
+    Position res = place(seg, font, base, bbox, clusterMin, rtl, isFinal);
 
-    if (m_parent && m_sibling && m_sibling != this && m_sibling->attachedTo() == m_parent)
+    const pending start = { this, base.x, base.y, 0, true };
+    int top = stack_attached(stack, 0, this, start);
+    while (top)
     {
-        Position tRes = m_sibling->finalise(seg, font, base, bbox, attrLevel, clusterMin, rtl, isFinal, depth + 1);
-        if (tRes.x > res.x) res = tRes;
+        const pending p = stack[--top];
+        Slot * const s = p.slot;
+        Position sres;
+        if (p.depth <= MAX_ATTACH_DEPTH && !(attrLevel && s->m_attLevel > attrLevel))
+        {
+            sres = s->place(seg, font, Position(p.x, p.y), bbox, clusterMin, rtl, isFinal);
+            top = stack_attached(stack, top, s, p);
+        }
+        if (p.counts && sres.x > res.x)
+            res = sres;
     }
 
     if (!m_parent && clusterMin < base.x)
@@ -137,7 +197,7 @@ int32 Slot::clusterMetric(const Segment *seg, uint8 metric, uint8 attrLevel, boo
         return 0;
     Rect bbox = seg->theGlyphBBoxTemporary(glyph());
     float clusterMin = 0.;
-    Position res = finalise(seg, NULL, base, bbox, attrLevel, clusterMin, rtl, false);
+    Position res = finalise(seg, NULL, base, &bbox, attrLevel, clusterMin, rtl, false);
 
     switch (metrics(metric))
     {
@@ -430,6 +490,7 @@ void Slot::setGlyph(Segment *seg, uint16 glyphid, const GlyphFace * theGlyph)
 {
     m_glyphid = glyphid;
     m_bidiCls = -1;
+    seg->addMatchPasses(glyphid);
     if (!theGlyph)
     {
         theGlyph = seg->getFace()->glyphs().glyphSafe(glyphid);
@@ -458,13 +519,24 @@ void Slot::setGlyph(Segment *seg, uint16 glyphid, const GlyphFace * theGlyph)
     }
 }
 
-void Slot::floodShift(Position adj, int depth)
+// Moves this slot, its siblings and everything attached below them.
+void Slot::floodShift(Position adj)
 {
-    if (depth > 100)
-        return;
-    m_position += adj;
-    if (m_child) m_child->floodShift(adj, depth + 1);
-    if (m_sibling) m_sibling->floodShift(adj, depth + 1);
+    Slot * stack[MAX_ATTACH_DEPTH + 2];
+    int depths[MAX_ATTACH_DEPTH + 2];
+    int top = 0;
+
+    stack[top] = this; depths[top++] = 0;
+    while (top)
+    {
+        Slot * const s = stack[--top];
+        const int depth = depths[top] + 1;
+        s->m_position += adj;
+        if (depth > MAX_ATTACH_DEPTH)
+            continue;
+        if (s->m_sibling) { stack[top] = s->m_sibling; depths[top++] = depth; }
+        if (s->m_child)   { stack[top] = s->m_child;   depths[top++] = depth; }
+    }
 }
 
 void SlotJustify::LoadSlot(const Slot *s, const Segment *seg)
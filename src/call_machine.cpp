@@ -50,6 +50,7 @@ struct regbank  {
     uint8           direction;
     int8            flags;
     Machine::status_t & status;
+    size_t          skipped;
 };
 
 typedef bool        (* ip_t)(registers);
@@ -67,6 +68,7 @@ namespace {
 #define flags   reg.flags
 #define dir     reg.direction
 #define status  reg.status
+#define skipped reg.skipped
 
 #include "inc/opcodes.h"
 
@@ -78,6 +80,7 @@ namespace {
 #undef mapb
 #undef flags
 #undef dir
+#undef skipped
 }
 
 Machine::stack_t  Machine::run(const instr   * program,
@@ -92,10 +95,13 @@ Machine::stack_t  Machine::run(const instr   * program,
     const byte    * dp = data;
     stack_t       * sp = _stack + Machine::STACK_GUARD,
             * const sb = sp;
-    regbank         reg = {*map, map, _map, _map.begin()+_map.context(), ip, _map.dir(), 0, _status};
+    regbank         reg = {*map, map, _map, _map.begin()+_map.context(), ip, _map.dir(), 0, _status, 0};
 
     // Run the program
     while ((reinterpret_cast<ip_t>(*++ip))(dp, sp, sb, reg)) {}
+    // Programs only jump forward, so all from the first to the last run
+    //  were either run or skipped.
+    if (_executed) *_executed += size_t(ip - program) + 1 - reg.skipped;
     const stack_t ret = sp == _stack+STACK_GUARD+1 ? *sp-- : 0;
 
     check_final_stack(sp);
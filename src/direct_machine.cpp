@@ -60,7 +60,8 @@ const void * direct_run(const bool          get_table_mode,
                         slotref         * & __map,
                         uint8                _dir,
                         Machine::status_t & status,
-                        SlotMap           * __smap=0)
+                        SlotMap           * __smap=0,
+                        size_t            * executed=0)
 {
     // We need to define and return to opcode table from within this function
     // other inorder to take the addresses of the instruction bodies.
@@ -80,6 +81,7 @@ const void * direct_run(const bool          get_table_mode,
                   * const mapb = smap.begin()+smap.context();
     uint8                  dir = _dir;
     int8                 flags = 0;
+    size_t             skipped = 0;
 
     // start the program
     goto **ip;
@@ -90,6 +92,9 @@ const void * direct_run(const bool          get_table_mode,
     end:
     __map  = map;
     *__map = is;
+    // Programs only jump forward, so all from the first to the last run
+    //  were either run or skipped.
+    if (executed) *executed += size_t(ip - program) + 1 - skipped;
     return sp;
 }
 
@@ -110,7 +115,7 @@ Machine::stack_t  Machine::run(const instr   * program,
     assert(program != 0);
 
     const stack_t *sp = static_cast<const stack_t *>(
-                direct_run(false, program, data, _stack, is, _map.dir(), _status, &_map));
+                direct_run(false, program, data, _stack, is, _map.dir(), _status, &_map, _executed));
     const stack_t ret = sp == _stack+STACK_GUARD+1 ? *sp-- : 0;
     check_final_stack(sp);
     return ret;
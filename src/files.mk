@@ -30,6 +30,7 @@ $(_NS)_SOURCES = \
     $($(_NS)_BASE)/src/Decompressor.cpp \
     $($(_NS)_BASE)/src/Face.cpp \
     $($(_NS)_BASE)/src/FeatureMap.cpp \
+    $($(_NS)_BASE)/src/FeatureSets.cpp \
     $($(_NS)_BASE)/src/FileFace.cpp \
     $($(_NS)_BASE)/src/Font.cpp \
     $($(_NS)_BASE)/src/GlyphCache.cpp \
@@ -41,6 +42,7 @@ $(_NS)_SOURCES = \
     $($(_NS)_BASE)/src/Position.cpp \
     $($(_NS)_BASE)/src/Segment.cpp \
     $($(_NS)_BASE)/src/Silf.cpp \
+    $($(_NS)_BASE)/src/SliceEdges.cpp \
     $($(_NS)_BASE)/src/Slot.cpp \
     $($(_NS)_BASE)/src/Sparse.cpp \
     $($(_NS)_BASE)/src/TtfUtil.cpp \
@@ -60,6 +62,7 @@ $(_NS)_PRIVATE_HEADERS = \
     $($(_NS)_BASE)/src/inc/Error.h \
     $($(_NS)_BASE)/src/inc/Face.h \
     $($(_NS)_BASE)/src/inc/FeatureMap.h \
+    $($(_NS)_BASE)/src/inc/FeatureSets.h \
     $($(_NS)_BASE)/src/inc/FeatureVal.h \
     $($(_NS)_BASE)/src/inc/FileFace.h \
     $($(_NS)_BASE)/src/inc/Font.h \
@@ -74,10 +77,13 @@ $(_NS)_PRIVATE_HEADERS = \
     $($(_NS)_BASE)/src/inc/opcode_table.h \
     $($(_NS)_BASE)/src/inc/opcodes.h \
     $($(_NS)_BASE)/src/inc/Pass.h \
+    $($(_NS)_BASE)/src/inc/PassCache.h \
     $($(_NS)_BASE)/src/inc/Position.h \
+    $($(_NS)_BASE)/src/inc/Profile.h \
     $($(_NS)_BASE)/src/inc/Rule.h \
     $($(_NS)_BASE)/src/inc/Segment.h \
     $($(_NS)_BASE)/src/inc/Silf.h \
+    $($(_NS)_BASE)/src/inc/SliceEdges.h \
     $($(_NS)_BASE)/src/inc/Slot.h \
     $($(_NS)_BASE)/src/inc/Sparse.h \
     $($(_NS)_BASE)/src/inc/TtfTypes.h \
@@ -6,7 +6,9 @@
 #include "inc/FileFace.h"
 #include "inc/GlyphCache.h"
 #include "inc/CmapCache.h"
+#include "inc/Segment.h"
 #include "inc/Silf.h"
+#include "inc/UtfCodec.h"
 #include "inc/json.h"
 
 using namespace graphite2;
@@ -46,7 +48,7 @@ namespace
                 return false;
             }
             else
-                return true;
+                return !(options & gr_face_collectProfile) || face.enableProfile();
         }
         else
             return false;
@@ -61,6 +63,90 @@ namespace
         if ((x & 0x000000FF) == 0x00000020)     return x & 0xFFFFFF00;
         return x;
     }
+
+    // A face without the memory for its coverage is asked directly.
+    int first_face(const gr_face * const * faces, const Coverage * const * covs, size_t nFaces, uint32 usv)
+    {
+        for (size_t f = 0; f != nFaces; ++f)
+        {
+            if (covs[f] ? (*covs[f])[usv] : faces[f] && gr_face_is_char_supported(faces[f], usv, 0))
+                return int(f);
+        }
+        return -1;
+    }
+
+    // The answers for ASCII are worked out up front.  Should one face be
+    // first for all of printable ASCII, as it mostly is, runs of it are
+    // found a block at a time and filled in without looking at each.
+    template <typename utf_iter>
+    size_t first_faces(const gr_face * const * faces, const Coverage * const * covs, size_t nFaces,
+                       utf_iter c, size_t nChars, int * res)
+    {
+        typedef typename utf_iter::codeunit_type codeunit_type;
+        typedef _utf_codec<sizeof(codeunit_type)*8> codec;
+
+        int ascii[0x80];
+        for (uint32 usv = 0; usv != 0x80; ++usv)
+            ascii[usv] = first_face(faces, covs, nFaces, usv);
+        bool uniform = true;
+        for (uint32 usv = 0x21; usv != 0x7F; ++usv)
+            uniform = uniform && ascii[usv] == ascii[0x20];
+
+        size_t i = 0;
+        bool look = uniform;
+        while (i != nChars)
+        {
+            if (look)
+            {
+                // Every character left takes at least one unit.
+                codeunit_type * const p = c;
+                const size_t n = codec::printable_run(p, p + (nChars - i));
+                for (int * r = res + i, * const re = r + n; r != re; ++r)
+                    *r = ascii[0x20];
+                i += n;
+                c = utf_iter(p + n);
+                if (i == nChars) break;
+            }
+            const uint32 usv = *c;
+            if (c.error()) break;
+            res[i++] = usv < 0x80 ? ascii[usv] : first_face(faces, covs, nFaces, usv);
+            look = uniform && usv < 0x80;
+            ++c;
+        }
+        return i;
+    }
+
+    // Shapes the text a piece at a time, so that a whole corpus may be given
+    // without holding a segment for all of it.
+    template <typename utf_iter>
+    void shape_pieces(const Face & face, gr_encform enc, utf_iter c, size_t nChars)
+    {
+        static const size_t piece = 1024;
+        const Silf * const silf = face.chooseSilf(0);
+        const Features & feats = face.theSill().features(0);
+
+        while (nChars)
+        {
+            // A nul or badly encoded character ends the text, but what was
+            // read before it in this piece is still shaped.
+            const size_t n = min(nChars, piece);
+            const void * const start = c;
+            size_t i = 0;
+            for (; i != n; ++i, ++c)
+            {
+                const uint32 usv = *c;
+                if (c.error() || !usv) break;
+            }
+            if (i == 0) return;
+            Segment * const seg = new Segment(i, &face, 0, silf ? silf->dir() : 0);
+            if (!seg) return;
+            if (seg->read_text(&face, &feats, enc, start, i) && seg->runGraphite())
+                seg->finalise(0);
+            delete seg;
+            if (i != n) return;
+            nChars -= n;
+        }
+    }
 }
 
 extern "C" {
@@ -128,6 +214,20 @@ gr_feature_val* gr_face_featureval_for_lang(const gr_face* pFace, gr_uint32 lang
     return static_cast<gr_feature_val *>(pFace->theSill().cloneFeatures(langname));
 }
 
+const gr_feature_val* gr_face_default_featureval(const gr_face* pFace, gr_uint32 langname)
+{
+    assert(pFace);
+    langname = zeropad(langname);
+    return static_cast<const gr_feature_val *>(pFace->featureSets().intern(pFace->theSill().features(langname)));
+}
+
+const gr_feature_val* gr_face_intern_featureval(const gr_face* pFace, const gr_feature_val* pFeats)
+{
+    assert(pFace);
+    if (!pFeats) return 0;
+    return static_cast<const gr_feature_val *>(pFace->featureSets().intern(*pFeats));
+}
+
 
 const gr_feature_ref* gr_face_find_fref(const gr_face* pFace, gr_uint32 featId)  //When finished with the FeatureRef, call destroy_FeatureRef
 {
@@ -202,6 +302,26 @@ const gr_faceinfo *gr_face_info(const gr_face *pFace, gr_uint32 script)
     return 0;
 }
 
+int gr_face_profile(const gr_face *pFace, unsigned int silf, unsigned int pass, int rule, gr_profile_counts *counts)
+{
+    if (!pFace) return -1;
+    int numRules = 0;
+    const gr_profile_counts * const p = pFace->getProfile(silf, pass, rule, numRules);
+    if (!p) return -1;
+    if (counts) *counts = *p;
+    return numRules;
+}
+
+void gr_face_set_collision_budget(gr_face *pFace, unsigned int maxFixes)
+{
+    if (pFace) pFace->setCollisionBudget(maxFixes);
+}
+
+size_t gr_face_collision_budget_trips(const gr_face *pFace)
+{
+    return pFace ? pFace->collisionTrips() : 0;
+}
+
 int gr_face_is_char_supported(const gr_face* pFace, gr_uint32 usv, gr_uint32 script)
 {
     const Cmap & cmap = pFace->cmap();
@@ -214,6 +334,53 @@ int gr_face_is_char_supported(const gr_face* pFace, gr_uint32 usv, gr_uint32 scr
     return (gid != 0);
 }
 
+const gr_uint32 * gr_face_coverage(const gr_face *pFace, gr_uint32 *pLimit)
+{
+    const Coverage * const cov = pFace ? pFace->coverage() : 0;
+    if (pLimit) *pLimit = cov ? cov->limit() : 0;
+    return cov ? cov->bits() : 0;
+}
+
+size_t gr_faces_first_supporting(const gr_face * const *pFaces, size_t nFaces, enum gr_encform enc, const void *pStart, size_t nChars, int *pFaceIndex)
+{
+    if (!nChars) return 0;
+    assert(pFaces || !nFaces);
+    assert(pStart);
+    assert(pFaceIndex);
+
+    const Coverage ** const covs = gralloc<const Coverage *>(nFaces ? nFaces : 1);
+    if (!covs) return 0;
+    for (size_t f = 0; f != nFaces; ++f)
+        covs[f] = pFaces[f] ? pFaces[f]->coverage() : 0;
+
+    size_t res = 0;
+    switch (enc)
+    {
+    case gr_utf8:   res = first_faces(pFaces, covs, nFaces, utf8::const_iterator(pStart), nChars, pFaceIndex); break;
+    case gr_utf16:  res = first_faces(pFaces, covs, nFaces, utf16::const_iterator(pStart), nChars, pFaceIndex); break;
+    case gr_utf32:  res = first_faces(pFaces, covs, nFaces, utf32::const_iterator(pStart), nChars, pFaceIndex); break;
+    }
+    free(covs);
+    return res;
+}
+
+size_t gr_face_preload_text(const gr_face *pFace, enum gr_encform enc, const void *pStart, size_t nChars)
+{
+    assert(pFace);
+    assert(pStart || !nChars);
+    const GlyphCache & glyphs = pFace->glyphs();
+    if (glyphs.preloaded() || !nChars) return 0;
+
+    const size_t before = glyphs.numLoaded();
+    switch (enc)
+    {
+    case gr_utf8:   shape_pieces(*pFace, enc, utf8::const_iterator(pStart), nChars); break;
+    case gr_utf16:  shape_pieces(*pFace, enc, utf16::const_iterator(pStart), nChars); break;
+    case gr_utf32:  shape_pieces(*pFace, enc, utf32::const_iterator(pStart), nChars); break;
+    }
+    return glyphs.numLoaded() - before;
+}
+
 #ifndef GRAPHITE2_NFILEFACE
 gr_face* gr_make_file_face(const char *filename, unsigned int faceOptions)
 {
@@ -111,5 +111,11 @@ void gr_featureval_destroy(gr_feature_val *p)
     delete static_cast<Features*>(p);
 }
 
+gr_uint32 gr_featureval_hash(const gr_feature_val* pfeatures)
+{
+    assert(pfeatures);
+    return pfeatures->hash();
+}
+
 
 } // extern "C"
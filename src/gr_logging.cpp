@@ -131,6 +131,9 @@ json & graphite2::operator << (json & j, const telemetry & t) throw()
             << "code"   << t.code
             << "misc"   << t.misc
             << "total"  << (t.silf + t.states + t.starts + t.transitions + t.glyph + t.code + t.misc)
+            << "rules"  << t.rules
+            << "folded_rules" << t.folded_rules
+            << "folded_slots" << t.folded_slots
         << json::close;
     return j;
 }
@@ -10,17 +10,19 @@ using namespace graphite2;
 namespace
 {
 
-  gr_segment* makeAndInitialize(const Font *font, const Face *face, uint32 script, const Features* pFeats/*must not be NULL*/, gr_encform enc, const void* pStart, size_t nChars, int dir)
+  Segment* newSegment(const Face *face, uint32 script, size_t nChars, int dir)
   {
       if (script == 0x20202020) script = 0;
       else if ((script & 0x00FFFFFF) == 0x00202020) script = script & 0xFF000000;
       else if ((script & 0x0000FFFF) == 0x00002020) script = script & 0xFFFF0000;
       else if ((script & 0x000000FF) == 0x00000020) script = script & 0xFFFFFF00;
       // if (!font) return NULL;
-      Segment* pRes=new Segment(nChars, face, script, dir);
-
+      return new Segment(nChars, face, script, dir);
+  }
 
-      if (!pRes->read_text(face, pFeats, enc, pStart, nChars) || !pRes->runGraphite())
+  gr_segment* shapeAndFinalise(Segment *pRes, const Font *font, bool read)
+  {
+      if (!read || !pRes->runGraphite())
       {
         delete pRes;
         return NULL;
@@ -30,6 +32,12 @@ namespace
       return static_cast<gr_segment*>(pRes);
   }
 
+  gr_segment* makeAndInitialize(const Font *font, const Face *face, uint32 script, const Features* pFeats/*must not be NULL*/, gr_encform enc, const void* pStart, size_t nChars, int dir)
+  {
+      Segment* pRes = newSegment(face, script, nChars, dir);
+      return shapeAndFinalise(pRes, font, pRes->read_text(face, pFeats, enc, pStart, nChars));
+  }
+
   template <typename utf_iter>
   inline size_t count_unicode_chars(utf_iter first, const utf_iter last, const void **error)
   {
@@ -44,7 +52,10 @@ namespace
               return 0;
           }
           for (;first != last; ++first, ++n_chars)
-              if ((usv = *first) == 0 || first.error()) break;
+          {
+              n_chars += first.skip_plain(last);
+              if (first == last || (usv = *first) == 0 || first.error()) break;
+          }
       }
       else
       {
@@ -58,6 +69,18 @@ namespace
       if (error)  *error = first.error() ? first : 0;
       return n_chars;
   }
+
+  // How many code units there are before e, or the first nul if e is 0;
+  // never fewer than the characters they hold.
+  template <typename C>
+  inline size_t count_code_units(const void * s, const void * e)
+  {
+      const C * const b = static_cast<const C *>(s);
+      if (e) return static_cast<const C *>(e) > b ? static_cast<const C *>(e) - b : 0;
+      const C * p = b;
+      while (*p) ++p;
+      return p - b;
+  }
 }
 
 
@@ -81,13 +104,52 @@ gr_segment* gr_make_seg(const gr_font *font, const gr_face *face, gr_uint32 scri
 {
     if (!face) return nullptr;
 
-    const gr_feature_val * tmp_feats = 0;
-    if (pFeats == 0)
-        pFeats = tmp_feats = static_cast<const gr_feature_val*>(face->theSill().cloneFeatures(0));
-    gr_segment * seg = makeAndInitialize(font, face, script, pFeats, enc, pStart, nChars, dir);
-    delete static_cast<const FeatureVal*>(tmp_feats);
+    const Features & feats = pFeats ? *pFeats : face->theSill().features(0);
+    return makeAndInitialize(font, face, script, &feats, enc, pStart, nChars, dir);
+}
+
 
-    return seg;
+gr_segment* gr_make_seg_from_buffer(const gr_font *font, const gr_face *face, gr_uint32 script, const gr_feature_val* pFeats, gr_encform enc, const void* pStart, const void* pEnd, int dir, const void** pError)
+{
+    if (pError) *pError = 0;
+    if (!face || !pStart) return nullptr;
+
+    // The text is decoded just the once, straight into a segment with room
+    // for a character per code unit.
+    size_t nUnits;
+    switch (enc)
+    {
+    case gr_utf8:   nUnits = count_code_units<uint8>(pStart, pEnd); break;
+    case gr_utf16:  nUnits = count_code_units<uint16>(pStart, pEnd); break;
+    case gr_utf32:  nUnits = count_code_units<uint32>(pStart, pEnd); break;
+    default:        return nullptr;
+    }
+    const Features & feats = pFeats ? *pFeats : face->theSill().features(0);
+    Segment * pRes = newSegment(face, script, nUnits, dir);
+    return shapeAndFinalise(pRes, font, pRes->read_buffer(face, &feats, enc, pStart, pEnd, pError));
+}
+
+
+gr_segment* gr_make_seg_from_glyphs(const gr_font *font, const gr_face *face, gr_uint32 script, const gr_feature_val* pFeats, const gr_uint16* pGlyphs, const size_t* pOffsets, const gr_uint32* pChars, size_t nGlyphs, int dir)
+{
+    if (!face || !pGlyphs) return nullptr;
+
+    const Features & feats = pFeats ? *pFeats : face->theSill().features(0);
+    Segment * pRes = newSegment(face, script, nGlyphs, dir);
+    return shapeAndFinalise(pRes, font, pRes->read_glyphs(face, &feats, pGlyphs, pOffsets, pChars, nGlyphs));
+}
+
+
+gr_segment* gr_make_seg_with_feature_runs(const gr_font *font, const gr_face *face, gr_uint32 script, const gr_feature_val* pFeats, gr_encform enc, const void* pStart, size_t nChars, int dir, const gr_feature_run* pRuns, size_t nRuns)
+{
+    if (!face || (nRuns && !pRuns)) return nullptr;
+
+    const Features & feats = pFeats ? *pFeats : face->theSill().features(0);
+    Segment * pRes = newSegment(face, script, nChars, dir);
+    bool ok = pRes->read_text(face, &feats, enc, pStart, nChars);
+    for (const gr_feature_run * r = pRuns, * const re = pRuns + nRuns; ok && r != re; ++r)
+        ok = r->features && pRes->setFeatureRun(r->start, r->length, *r->features);
+    return shapeAndFinalise(pRes, font, ok);
 }
 
 
@@ -149,4 +211,18 @@ float gr_seg_justify(gr_segment* pSeg/*not NULL*/, const gr_slot* pSlot/*not NUL
     return pSeg->justify(const_cast<gr_slot *>(pSlot), pFont, float(width), justFlags(flags), const_cast<gr_slot *>(pFirst), const_cast<gr_slot *>(pLast));
 }
 
+void gr_seg_justify_lines(gr_segment* pSeg/*not NULL*/, const gr_slot* const* pStarts/*not NULL*/, size_t numLines, const gr_font *pFont, double width, enum gr_justFlags flags, float *pWidths)
+{
+    assert(pSeg);
+    assert(pStarts || !numLines);
+    pSeg->justifyLines(reinterpret_cast<const Slot * const *>(pStarts), numLines, pFont, float(width), justFlags(flags), pWidths);
+}
+
+void gr_seg_rescale(gr_segment* pSeg/*not NULL*/, const gr_font *pFont)
+{
+    assert(pSeg);
+    assert(!pFont || &pFont->face() == pSeg->getFace());
+    pSeg->place(pFont);
+}
+
 } // extern "C"
@@ -20,6 +20,10 @@ public:
 
     virtual operator bool () const throw() { return false; }
 
+    // Sets the bit in bits for each code point mapped to a glyph.  bits has
+    // room for every one up to 0x10FFFF.
+    virtual void cover(uint32 *) const throw() {}
+
     CLASS_NEW_DELETE;
 };
 
@@ -32,6 +36,7 @@ public:
     DirectCmap(const Face &);
     virtual uint16 operator [] (const uint32 usv) const throw();
     virtual operator bool () const throw();
+    virtual void cover(uint32 * bits) const throw();
 
     CLASS_NEW_DELETE;
 private:
@@ -50,10 +55,62 @@ public:
     virtual ~CachedCmap() throw();
     virtual uint16 operator [] (const uint32 usv) const throw();
     virtual operator bool () const throw();
+    virtual void cover(uint32 * bits) const throw();
     CLASS_NEW_DELETE;
 private:
     bool m_isBmpOnly;
     uint16 ** m_blocks;
 };
 
+// The BMP and SMP subtables copied once into native byte order, so each
+// lookup is a plain binary search.
+class NativeCmap : public Cmap
+{
+    NativeCmap(const NativeCmap &);
+    NativeCmap & operator = (const NativeCmap &);
+
+public:
+    NativeCmap(const Face &);
+    virtual ~NativeCmap() throw();
+    virtual uint16 operator [] (const uint32 usv) const throw();
+    virtual operator bool () const throw();
+    virtual void cover(uint32 * bits) const throw();
+    CLASS_NEW_DELETE;
+private:
+    uint16      bmp(const uint32 usv) const throw();
+    uint16      smp(const uint32 usv) const throw();
+    static uint32 sort_groups(uint32 * groups, uint32 numGroups) throw();
+
+    uint16    * m_bmp;          // the whole format 4 subtable
+    uint32    * m_groups;       // format 12 start, end and glyph triples, in order
+    uint32      m_numGroups;
+    uint16      m_bmpLength,    // in uint16s
+                m_numSegs;
+};
+
+// The characters a face supports, one bit for each code point: those its
+// cmap maps to a glyph and those its Silf has a pseudo glyph for, just as
+// gr_face_is_char_supported finds them.  The set stops after the last word
+// with any character in it, so a face covering only the BMP takes 8KiB.
+class Coverage
+{
+    Coverage(const Coverage &);
+    Coverage & operator = (const Coverage &);
+
+public:
+    Coverage(const Face &) throw();
+    ~Coverage() throw();
+
+    bool operator [] (const uint32 usv) const throw()   { return usv < m_limit && (m_bits[usv >> 5] >> (usv & 31)) & 1; }
+    operator bool () const throw()                      { return m_bits != 0; }
+
+    const uint32  * bits() const throw()    { return m_bits; }
+    uint32          limit() const throw()   { return m_limit; }
+
+    CLASS_NEW_DELETE;
+private:
+    uint32    * m_bits;
+    uint32      m_limit;
+};
+
 } // namespace graphite2
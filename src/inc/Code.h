@@ -83,6 +83,7 @@ public:
     size_t        maxRef() const throw()            { return _max_ref; }
     void          externalProgramMoved(ptrdiff_t) throw();
 
+    bool  refsInRange(Machine &m) const;
     int32 run(Machine &m, slotref * & map) const;
 
     CLASS_NEW_DELETE;
@@ -97,6 +97,18 @@ private:
 struct BBox;
 struct SlantBox;
 
+// Bounds on x, y, x - y and x + y, the extents of an octabox.
+struct OctaBounds
+{
+    float xi, xa, yi, ya, di, da, si, sa;
+
+    bool meets(const OctaBounds &o) const
+    {
+        return !(xa < o.xi) && !(xi > o.xa) && !(ya < o.yi) && !(yi > o.ya)
+            && !(da < o.di) && !(di > o.da) && !(sa < o.si) && !(si > o.sa);
+    }
+};
+
 class ShiftCollider
 {
 public:
@@ -115,6 +127,7 @@ public:
     Position resolve(Segment *seg, bool &isCol, GR_MAYBE_UNUSED json * const dbgout);
     void addBox_slope(bool isx, const Rect &box, const BBox &bb, const SlantBox &sb, const Position &org, float weight, float m, bool minright, int mode);
     void removeBox(const Rect &box, const BBox &bb, const SlantBox &sb, const Position &org, int mode);
+    void reach(Segment *seg, OctaBounds regions[4]) const;
     const Position &origin() const { return _origin; }
 
 #if !defined GRAPHITE2_NTRACING
@@ -161,6 +174,41 @@ ShiftCollider::ShiftCollider(GR_MAYBE_UNUSED json *dbgout)
 #endif
 }
 
+// The slots of a collision range with their octaboxes, kept in order of
+// left edge so that fixing a glyph need only visit the neighbours it could
+// reach rather than every slot in the range.  Boxes go stale as slots move,
+// so whatever moves one must update() it.
+class SlotIndex
+{
+public:
+    SlotIndex() : _revStop(0), _maxWidth(0) {}
+
+    void build(Segment *seg, Slot *first, Slot *end);
+    void update(Segment *seg, Slot *slot);
+    void select(const OctaBounds regions[4], const Slot *keep, const Slot *cluster);
+    Slot *next(const Slot *slot, bool isRev) const;
+
+    CLASS_NEW_DELETE;
+
+private:
+    struct Entry { OctaBounds box; uint32 pos; };
+
+    void place(Segment *seg, Slot *slot, Entry &e) const;
+    void mark(const Slot *slot);
+    void markChildren(const Slot *slot);
+    static int cmpLeft(const void *a, const void *b);
+
+    Vector<Entry>   _entries;   // sorted by left edge
+    Vector<uint32>  _entryOf;   // by range position
+    Vector<Slot *>  _slots;     // in range order
+    Vector<uint32>  _posOf;     // by slot index, range position or ~0
+    Vector<uint32>  _always;    // bitset of positions merged whatever their box
+    Vector<uint32>  _marks;     // bitset of positions select() picked
+    uint32          _revStop;   // where a backward walk from the end stops
+    float           _maxWidth;
+};
+
+
 class KernCollider
 {
 public:
@@ -3,12 +3,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstdio>
 
 #include "graphite2/Font.h"
 
 #include "inc/Main.h"
 #include "inc/FeatureMap.h"
+#include "inc/FeatureSets.h"
 #include "inc/TtfUtil.h"
 #include "inc/Silf.h"
 #include "inc/Error.h"
@@ -16,6 +18,7 @@
 namespace graphite2 {
 
 class Cmap;
+class Coverage;
 class FileFace;
 class GlyphCache;
 class NameTable;
@@ -35,7 +38,6 @@ class Face
 
 public:
     class Table;
-    static float default_glyph_advance(const void* face_ptr, gr_uint16 glyphid);
 
     Face(const void* appFaceHandle/*non-NULL*/, const gr_face_ops & ops);
     virtual ~Face();
@@ -51,14 +53,25 @@ public:
     const SillMap     & theSill() const;
     const GlyphCache  & glyphs() const;
     Cmap              & cmap() const;
+    const Coverage    * coverage() const;
     NameTable         * nameTable() const;
     void                setLogger(FILE *log_file);
     json              * logger() const throw();
 
     const Silf        * chooseSilf(uint32 script) const;
+    bool                enableProfile();
+    const gr_profile_counts * getProfile(unsigned int silf, unsigned int pass, int rule, int & numRules) const;
     uint16              languageForLocale(const char * locale) const;
 
+    // Collision budget: the most glyph fixes the shift collider may make in
+    // a segment, or 0 for no limit, and how many segments have run out.
+    uint32              collisionBudget() const { return m_collBudget; }
+    void                setCollisionBudget(uint32 n) { m_collBudget = n; }
+    void                countCollisionTrip() const { m_collTrips.fetch_add(1, std::memory_order_relaxed); }
+    size_t              collisionTrips() const { return m_collTrips.load(std::memory_order_relaxed); }
+
     // Features
+    const FeatureSets & featureSets() const { return m_featureSets; }
     uint16              numFeatures() const;
     const FeatureRef  * featureById(uint32 id) const;
     const FeatureRef  * feature(uint16 index) const;
@@ -85,6 +98,10 @@ private:
     mutable json          * m_logger;
     unsigned int            m_error;
     unsigned int            m_errcntxt;
+    uint32                  m_collBudget;
+    mutable std::atomic<size_t> m_collTrips;
+    FeatureSets             m_featureSets;
+    mutable std::atomic<Coverage *> m_coverage; // made when first asked for
 protected:
     Silf                  * m_silfs;    // silf subtables.
     uint16                  m_numSilf;  // num silf subtables in the silf table
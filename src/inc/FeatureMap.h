@@ -156,6 +156,7 @@ public:
     bool readFace(const Face & face);
     bool readSill(const Face & face);
     FeatureVal* cloneFeatures(uint32 langname/*0 means default*/) const;      //call destroy_Features when done.
+    const Features & features(uint32 langname/*0 means default*/) const;
     uint16 numLanguages() const { return m_numLanguages; };
     uint32 getLangName(uint16 index) const { return (index < m_numLanguages)? m_langFeats[index].m_lang : 0; };
 
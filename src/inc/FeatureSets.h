@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+
+// Interns the feature settings used with a face, so each different set is
+// held once and can be named by a pointer that stays good for the life of
+// the face: two interned sets are equal exactly when their pointers are.
+// Sets are only ever added, each claiming a free place with one compare and
+// swap, so segments made concurrently on one face can intern without a lock.
+// A set looks in a few places from where its hash falls, and if all those
+// are taken by others it simply goes uninterned.
+
+#pragma once
+
+#include <atomic>
+#include "inc/Main.h"
+#include "inc/FeatureVal.h"
+
+namespace graphite2 {
+
+class FeatureSets
+{
+public:
+    enum { MAX_SETS = 256, MAX_PROBES = 16 };
+
+    FeatureSets() throw();
+    ~FeatureSets() throw();
+
+    // Returns the interned copy of feats, or 0 if there is no room for it.
+    const Features * intern(const Features & feats) const throw();
+
+    CLASS_NEW_DELETE
+private:
+    struct Set
+    {
+        Set(const Features & f, uint32 h) : feats(f), hash(h) {}
+        Features    feats;
+        uint32      hash;
+        CLASS_NEW_DELETE
+    };
+
+    mutable std::atomic<Set *>  m_sets[MAX_SETS];
+
+    FeatureSets(const FeatureSets &);
+    FeatureSets & operator = (const FeatureSets &);
+};
+
+} // namespace graphite2
@@ -31,6 +31,15 @@ public:
         return n == 0;
     }
 
+    // FNV-1a over the words, for keeping sets in a table.
+    uint32 hash() const
+    {
+        uint32 h = 2166136261u;
+        for (const_iterator i = begin(); i != end(); ++i)
+            h = (h ^ *i) * 16777619u;
+        return h;
+    }
+
     CLASS_NEW_DELETE
 private:
     friend class FeatureRef;        //so that FeatureRefs can manipulate m_vec directly
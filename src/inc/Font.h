@@ -6,6 +6,8 @@
 #include "graphite2/Font.h"
 #include "inc/Main.h"
 #include "inc/Face.h"
+#include "inc/GlyphCache.h"
+#include "inc/GlyphFace.h"
 
 namespace graphite2 {
 
@@ -18,29 +20,41 @@ public:
     virtual ~Font();
 
     float advance(unsigned short glyphid) const;
+    void prefetchAdvances(const uint16 * glyphids, size_t n) const;
+    bool batchesAdvances() const { return m_ops.glyph_advances_x != 0; }
     float scale() const;
     bool isHinted() const;
     const Face & face() const;
-    operator bool () const throw()  { return m_advances; }
+    operator bool () const throw()  { return m_advances || !m_hinted; }
 
     CLASS_NEW_DELETE;
 private:
     gr_font_ops         m_ops;
     const void  * const m_appFontHandle;
-    float             * m_advances;  // One advance per glyph in pixels. Nan if not defined
+    float             * m_advances;  // Hinted fonts only: one advance per glyph in pixels, INVALID_ADVANCE until asked for
     const Face        & m_face;
     float               m_scale;      // scales from design units to ppm
     bool                m_hinted;
 
+    float batchedAdvance(uint16 glyphid) const;
+
     Font(const Font&);
     Font& operator=(const Font&);
 };
 
+// Unhinted advances are the design ones the face already holds, scaled.
 inline
 float Font::advance(unsigned short glyphid) const
 {
+    if (!m_advances)
+    {
+        const GlyphFace * const g = m_face.glyphs().glyphSafe(glyphid);
+        return g ? g->theAdvance().x * m_scale : 0;
+    }
     if (m_advances[glyphid] == INVALID_ADVANCE)
-        m_advances[glyphid] = (*m_ops.glyph_advance_x)(m_appFontHandle, glyphid);
+        m_advances[glyphid] = m_ops.glyph_advance_x
+                            ? (*m_ops.glyph_advance_x)(m_appFontHandle, glyphid)
+                            : batchedAdvance(glyphid);
     return m_advances[glyphid];
 }
 
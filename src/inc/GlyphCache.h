@@ -4,6 +4,7 @@
 #pragma once
 
 
+#include <atomic>
 #include "graphite2/Font.h"
 #include "inc/Main.h"
 #include "inc/Position.h"
@@ -63,6 +64,55 @@ private:
     Rect    _subs[1];
 };
 
+class GlyphCache;
+
+// A bounding box and its slant box side by side, as the colliders test them.
+struct CollisionBox
+{
+    BBox        bb;
+    SlantBox    sb;
+};
+
+// The boxes of every glyph laid out for the colliders.  Each glyph's overall
+// boxes are found by glyph id in one array, and its sub boxes follow one
+// another in a second.  Boxes are 32 byte aligned so none straddles a cache
+// line.  On a face whose glyphs are read on demand the overall boxes are
+// instead filled in as each glyph is first asked for, and its sub boxes are
+// read where the glyph cache holds them, so no more of the font is read than
+// shaping needs.
+class CollisionGeometry
+{
+    CollisionGeometry(const CollisionGeometry &);
+    CollisionGeometry & operator = (const CollisionGeometry &);
+
+public:
+    enum { ALIGN = 32 };
+
+    CollisionGeometry(const GlyphCache & gc);
+    ~CollisionGeometry() throw();
+
+    operator bool () const throw()                  { return _boxes != 0; }
+    bool                    check(uint16 gid) const { return gid < _num_glyphs; }
+    const CollisionBox    & box(uint16 gid) const   { fill(gid); return _boxes[gid]; }
+    uint8                   numSubs(uint16 gid) const;
+    const CollisionBox    * subs(uint16 gid) const;
+
+    CLASS_NEW_DELETE;
+
+private:
+    void fill(uint16 gid) const;
+    void load(uint16 gid) const;
+
+    const GlyphCache  * _lazy;  // the cache to fill from, unless preloaded
+    byte              * _block;
+    CollisionBox      * _boxes,
+                      * _subs;
+    uint32            * _first; // each glyph's first sub box, then the total
+    uint32            * _filled; // if lazy, which glyphs' boxes are in
+    uint16              _num_glyphs;
+};
+
+
 class GlyphCache
 {
     class Loader;
@@ -88,8 +138,16 @@ public:
     const BBox &     getBoundingBBox(unsigned short glyphid) const;
     const SlantBox & getSubBoundingSlantBox(unsigned short glyphid, uint8 subindex) const;
     const BBox &     getSubBoundingBBox(unsigned short glyphid, uint8 subindex) const;
+    // A glyph's sub boxes, each a bounding box then its slant box.
+    const CollisionBox * subBoxes(unsigned short glyphid) const { return reinterpret_cast<const CollisionBox *>(_boxes[glyphid]->subs()); }
     bool             check(unsigned short glyphid) const;
     bool             hasBoxes() const { return _boxes != 0; }
+    bool             preloaded() const { return _glyphs && !_glyph_loader; }
+    unsigned short   numLoaded() const;
+    // The colliders' copy of the glyph boxes, made the first time it is
+    // asked for.  Returns 0 if the font has no boxes or there was no memory
+    // for it.
+    const CollisionGeometry * collisionGeometry() const;
 
     CLASS_NEW_DELETE;
 
@@ -101,6 +159,7 @@ private:
     unsigned short        _num_glyphs,
                           _num_attrs,
                           _upem;
+    mutable std::atomic<CollisionGeometry *> _collision_geometry;
 };
 
 inline
@@ -197,4 +256,28 @@ uint8 GlyphCache::numSubBounds(unsigned short glyphid) const
     return _boxes[glyphid] ? _boxes[glyphid]->num() : 0;
 }
 
+
+inline
+void CollisionGeometry::fill(uint16 gid) const
+{
+    if (_filled && !((_filled[gid >> 5] >> (gid & 31)) & 1))
+        load(gid);
+}
+
+inline
+uint8 CollisionGeometry::numSubs(uint16 gid) const
+{
+    if (!_lazy) return uint8(_first[gid + 1] - _first[gid]);
+    fill(gid);
+    return _lazy->numSubBounds(gid);
+}
+
+inline
+const CollisionBox * CollisionGeometry::subs(uint16 gid) const
+{
+    if (!_lazy) return _subs + _first[gid];
+    fill(gid);
+    return _lazy->subBoxes(gid);
+}
+
 } // namespace graphite2
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <iterator>
 #include <utility>
 
 #include "inc/Main.h"
@@ -136,6 +136,9 @@ public:
 
     SlotMap   & slotMap() const throw();
     status_t    status() const throw();
+    // Adds the number of instructions each program run executes to *n, or
+    // stops counting given 0.
+    void        countInstructions(size_t * n) throw();
 //    operator bool () const throw();
 
 private:
@@ -146,10 +149,11 @@ private:
     SlotMap       & _map;
     stack_t         _stack[STACK_MAX + 2*STACK_GUARD];
     status_t        _status;
+    size_t        * _executed;
 };
 
 inline Machine::Machine(SlotMap & map) throw()
-: _map(map), _status(finished)
+: _map(map), _status(finished), _executed(0)
 {
     // Initialise stack guard +1 entries as the stack pointer points to the
     //  current top of stack, hence the first push will never write entry 0.
@@ -169,6 +173,11 @@ inline Machine::status_t Machine::status() const throw()
     return _status;
 }
 
+inline void Machine::countInstructions(size_t * n) throw()
+{
+    _executed = n;
+}
+
 inline void Machine::check_final_stack(const stack_t * const sp)
 {
     if (_status != finished) return;
@@ -38,8 +38,12 @@ struct telemetry
             states,
             starts,
             transitions;
+    size_t  rules,      // rule and folded constraint counts, not bytes
+            folded_rules,
+            folded_slots;
 
-    telemetry() : misc(0), silf(0), glyph(0), code(0), states(0), starts(0), transitions(0) {}
+    telemetry() : misc(0), silf(0), glyph(0), code(0), states(0), starts(0), transitions(0),
+                  rules(0), folded_rules(0), folded_slots(0) {}
 };
 
 class telemetry::category
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <cstdlib>
+#include "graphite2/Font.h"
 #include "inc/Code.h"
 
 namespace graphite2 {
@@ -17,6 +18,7 @@ struct State;
 class FiniteStateMachine;
 class Error;
 class ShiftCollider;
+class SlotIndex;
 class KernCollider;
 class json;
 
@@ -24,23 +26,38 @@ enum passtype;
 
 class Pass
 {
+    // A cell of the packed transition table.  check holds the low 16 bits of
+    // the row base that owns it; a cell no row owns holds those of a base
+    // past it, which no lookup landing there can have.
+    struct Transition { uint16 next, check; };
+
 public:
     Pass();
     ~Pass();
 
     bool readPass(const byte * pPass, size_t pass_length, size_t subtable_base, Face & face,
         enum passtype pt, uint32 version, Error &e);
-    bool runGraphite(vm::Machine & m, FiniteStateMachine & fsm, bool reverse) const;
+    bool runGraphite(vm::Machine & m, FiniteStateMachine & fsm, bool reverse, bool check_constraint = true) const;
+    bool testPassConstraint(vm::Machine & m) const;
     void init(Silf *silf) { m_silf = silf; }
     byte collisionLoops() const { return m_numCollRuns; }
+    bool hasCollisions() const { return m_numCollRuns || m_kernColls; }
+    bool featureConstraint() const { return m_featConstraint; }
     bool reverseDir() const { return m_isReverseDir; }
+    uint16 numRules() const { return m_numRules; }
+    bool enableProfile();
+    const gr_profile_counts * getProfile(int rule) const;
+    bool shareColumns(const Pass & p);
+    void markStarts(uint32 * glyph_masks, size_t stride, size_t num_glyphs, uint32 bit) const;
 
     CLASS_NEW_DELETE
 private:
     void    findNDoRule(Slot* & iSlot, vm::Machine &, FiniteStateMachine& fsm) const;
-    int     doAction(const vm::Machine::Code* codeptr, Slot * & slot_out, vm::Machine &) const;
-    bool    testPassConstraint(vm::Machine & m) const;
+    bool    runPassConstraint(vm::Machine & m, Slot * at) const;
+    bool    testFeatureRuns(vm::Machine & m, uint32 * on, bool & partial) const;
+    int     doAction(const Rule & r, Slot * & slot_out, vm::Machine &) const;
     bool    testConstraint(const Rule & r, vm::Machine &) const;
+    bool    testConstraint(const Rule & r, vm::Machine &, bool timed) const;
     bool    readRules(const byte * rule_map, const size_t num_entries,
                      const byte *precontext, const uint16 * sort_key,
                      const uint16 * o_constraint, const byte *constraint_data,
@@ -48,15 +65,24 @@ private:
                      Face &, enum passtype pt, Error &e);
     bool    readStates(const byte * starts, const byte * states, const byte * o_rule_map, Face &, Error &e);
     bool    readRanges(const byte * ranges, size_t num_ranges, Error &e);
+    bool    packTransitions(const byte * states);
+    void    foldConstraints(const uint16 * o_constraint, const byte * rc_data, Face &);
+    bool    glyphInFilter(uint16 filter, uint16 gid) const;
+    gr_profile_counts * ruleProfile(const Rule & r) const;
+    void    profile(const Rule & r, size_t gr_profile_counts::* counter, size_t n = 1) const;
+    int32   runCode(const Rule & r, const vm::Machine::Code & c, vm::Machine & m, vm::slotref * & map) const;
     uint16  glyphToCol(const uint16 gid) const;
+    uint16  transition(uint16 state, uint16 col) const;
     bool    runFSM(FiniteStateMachine & fsm, Slot * slot) const;
     void    dumpRuleEventConsidered(const FiniteStateMachine & fsm, const RuleEntry & re) const;
     void    dumpRuleEventOutput(const FiniteStateMachine & fsm, const Rule & r, Slot * os) const;
     void    adjustSlot(int delta, Slot * & slot_out, SlotMap &) const;
     bool    collisionShift(Segment *seg, int dir, json * const dbgout) const;
+    bool    collisionShiftRange(Segment *seg, Slot *start, Slot *end, int dir, ShiftCollider &coll,
+                     SlotIndex *index, bool &moved, json * const dbgout) const;
     bool    collisionKern(Segment *seg, int dir, json * const dbgout) const;
     bool    collisionFinish(Segment *seg, GR_MAYBE_UNUSED json * const dbgout) const;
-    bool    resolveCollisions(Segment *seg, Slot *slot, Slot *start, ShiftCollider &coll, bool isRev,
+    bool    resolveCollisions(Segment *seg, Slot *slot, Slot *start, ShiftCollider &coll, SlotIndex *index, bool isRev,
                      int dir, bool &moved, bool &hasCol, json * const dbgout) const;
     float   resolveKern(Segment *seg, Slot *slot, Slot *start, int dir,
                      float &ymin, float &ymax, json *const dbgout) const;
@@ -66,10 +92,14 @@ private:
     Rule              * m_rules; // rules
     RuleEntry         * m_ruleMap;
     uint16            * m_startStates; // prectxt length
-    uint16            * m_transitions;
+    Transition        * m_transitions;  // rows overlaid at m_rowBase offsets
+    uint32            * m_rowBase;
     State             * m_states;
     vm::Machine::Code * m_codes;
     byte              * m_progs;
+    uint32            * m_filters;      // glyph bitsets of folded constraints
+    uint16            * m_ruleFilters;  // per rule slot index into m_filters
+    gr_profile_counts * m_profile;      // pass totals then per rule, or 0
 
     byte   m_numCollRuns;
     byte   m_kernColls;
@@ -85,6 +115,8 @@ private:
     byte m_maxPreCtxt;
     byte m_colThreshold;
     bool m_isReverseDir;
+    bool m_sharedCols;
+    bool m_featConstraint;  // pass constraint reads only features
     vm::Machine::Code m_cPConstraint;
 
 private:        //defensive
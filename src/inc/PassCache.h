@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+
+// Remembers, per feature set, which passes with constraints that only read
+// feature values are active.  Sets are known by the face's interned copy.
+// An entry is claimed by setting its key, then filled and published once and
+// never changes afterwards, so segments made concurrently on one face can
+// share them without a lock.  Entries are claimed in order, so no set is
+// given two; one still being filled is simply not used until it is
+// published.  Once every entry is taken further feature sets go uncached.
+
+#pragma once
+
+#include <atomic>
+#include "inc/Main.h"
+#include "inc/FeatureVal.h"
+
+namespace graphite2 {
+
+class PassCache
+{
+public:
+    enum { MAX_ENTRIES = 8, MAX_WORDS = 8 };
+
+    struct Entry
+    {
+        std::atomic<const Features *>   feats;  // 0 until claimed
+        std::atomic<bool>               ready;
+        uint32              known[MAX_WORDS];   // passes whose result is held
+        uint32              active[MAX_WORDS];  // of those, ones that run
+    };
+
+    PassCache() throw();
+
+    // Returns the published entry for the interned feats, or 0.  On a miss
+    // fill is set to a newly claimed entry the caller must complete and
+    // publish(), or to 0 when feats cannot be cached or another caller is
+    // filling its entry.
+    const Entry * find(const Features * feats, Entry * & fill) throw();
+    void publish(Entry * e) throw();
+
+    CLASS_NEW_DELETE
+private:
+    Entry   m_entries[MAX_ENTRIES];
+
+    PassCache(const PassCache &);
+    PassCache & operator = (const PassCache &);
+};
+
+inline
+PassCache::PassCache() throw()
+{
+    for (Entry * e = m_entries; e != m_entries + MAX_ENTRIES; ++e)
+    {
+        e->feats.store(0, std::memory_order_relaxed);
+        e->ready.store(false, std::memory_order_relaxed);
+    }
+}
+
+inline
+const PassCache::Entry * PassCache::find(const Features * feats, Entry * & fill) throw()
+{
+    fill = 0;
+    if (!feats) return 0;
+
+    for (Entry * e = m_entries; e != m_entries + MAX_ENTRIES; ++e)
+    {
+        const Features * f = e->feats.load(std::memory_order_acquire);
+        if (!f && e->feats.compare_exchange_strong(f, feats, std::memory_order_acquire))
+        {
+            memset(e->known, 0, sizeof(e->known));
+            memset(e->active, 0, sizeof(e->active));
+            fill = e;
+            return 0;
+        }
+        // f is now the entry's key, whether read or set by whoever claimed
+        // it first.  Ours may still be being filled by another thread.
+        if (f == feats)
+            return e->ready.load(std::memory_order_acquire) ? e : 0;
+    }
+    return 0;
+}
+
+inline
+void PassCache::publish(Entry * e) throw()
+{
+    e->ready.store(true, std::memory_order_release);
+}
+
+} // namespace graphite2
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+
+// Lightweight execution counters for passes and rules.  Everything here is
+// guarded by a null counts pointer, so faces made without
+// gr_face_collectProfile pay only for that test.
+
+#pragma once
+
+#include "graphite2/Font.h"
+#include "inc/Main.h"
+
+#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+#include <intrin.h>
+#endif
+
+namespace graphite2 {
+
+inline
+unsigned long long profile_clock() throw()
+{
+#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+    return __rdtsc();
+#elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
+    return __builtin_ia32_rdtsc();
+#elif defined __GNUC__ && defined __aarch64__
+    unsigned long long t;
+    __asm__ __volatile__ ("mrs %0, cntvct_el0" : "=r" (t));
+    return t;
+#else
+    return 0;
+#endif
+}
+
+// Reading the timestamp counter costs far more than bumping the counts, so
+// only one in every PROFILE_SAMPLE FSM runs of a pass is timed and the ticks
+// scaled up to match.
+enum { PROFILE_SAMPLE = 64 };
+
+// Adds the ticks spent in a scope to the cycles of a count.
+class profile_timer
+{
+    gr_profile_counts * const   _counts;
+    const unsigned long long    _start;
+
+    profile_timer(const profile_timer &);
+    profile_timer & operator = (const profile_timer &);
+public:
+    profile_timer(gr_profile_counts * counts) throw()
+    : _counts(counts), _start(counts ? profile_clock() : 0) {}
+
+    ~profile_timer() throw()
+    {
+        if (_counts) _counts->cycles += (profile_clock() - _start) * PROFILE_SAMPLE;
+    }
+};
+
+} // namespace graphite2
@@ -12,6 +12,7 @@ namespace graphite2 {
 struct Rule {
   const vm::Machine::Code * constraint,
                  * action;
+  const uint16   * filter;      // folded constraint glyph set per slot or 0
   unsigned short   sort;
   byte             preContext;
 #ifndef NDEBUG
@@ -32,6 +33,7 @@ inline
 Rule::Rule()
 : constraint(0),
   action(0),
+  filter(0),
   sort(0),
   preContext(0)
 {
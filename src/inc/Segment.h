@@ -29,6 +29,7 @@ typedef Vector<SlotJustify *>   JustifyRope;
 class Font;
 class Segment;
 class Silf;
+struct JustifyEntry;
 
 enum SpliceParam {
 /** sub-Segments longer than this are not cached
@@ -62,7 +63,8 @@ public:
 
     enum {
         SEG_INITCOLLISIONS = 1,
-        SEG_HASCOLLISIONS = 2
+        SEG_HASCOLLISIONS = 2,
+        SEG_COLLBUDGETSPENT = 4
     };
 
     size_t slotCount() const { return m_numGlyphs; }      //one slot per glyph
@@ -89,11 +91,11 @@ public:
     SlotJustify *newJustify();
     void freeJustify(SlotJustify *aJustify);
     Position positionSlots(const Font *font=0, Slot *first=0, Slot *last=0, bool isRtl = false, bool isFinal = true);
-    void associateChars(int offset, size_t num);
+    bool associateChars(int offset, size_t num);
     void linkClusters(Slot *first, Slot *last);
     uint16 getClassGlyph(uint16 cid, uint16 offset) const { return m_silf->getClassGlyph(cid, offset); }
     uint16 findClassIndex(uint16 cid, uint16 gid) const { return m_silf->findClassIndex(cid, gid); }
-    int addFeatures(const Features& feats) { m_feats.push_back(feats); return int(m_feats.size()) - 1; }
+    int addFeatures(const Features& feats);
     uint32 getFeature(int index, uint8 findex) const { const FeatureRef* pFR=m_face->theSill().theFeatureMap().featureRef(findex); if (!pFR) return 0; else return pFR->getFeatureVal(m_feats[index]); }
     void setFeature(int index, uint8 findex, uint32 val) {
         const FeatureRef* pFR=m_face->theSill().theFeatureMap().featureRef(findex);
@@ -101,12 +103,15 @@ public:
         {
             if (val > pFR->maxVal()) val = pFR->maxVal();
             pFR->applyValToFeature(val, m_feats[index]);
+            m_featKeys[index] = 0;
         } }
     int8 dir() const { return m_dir; }
     void dir(int8 val) { m_dir = val; }
     bool currdir() const { return ((m_dir >> 6) ^ m_dir) & 1; }
     uint8 passBits() const { return m_passBits; }
     void mergePassBits(const uint8 val) { m_passBits &= val; }
+    bool mayMatch(uint8 pass) const { return (m_matchPasses[pass >> 5] >> (pass & 31)) & 1; }
+    void addMatchPasses(uint16 gid);
     int16 glyphAttr(uint16 gid, uint16 gattr) const { const GlyphFace * p = m_face->glyphs().glyphSafe(gid); return p ? p->attrs()[gattr] : 0; }
     int32 getGlyphMetric(Slot *iSlot, uint8 metric, uint8 attrLevel, bool rtl) const;
     float glyphAdvance(uint16 gid) const { return m_face->glyphs().glyph(gid)->theAdvance().x; }
@@ -115,7 +120,11 @@ public:
     int numAttrs() const { return m_silf->numUser(); }
     int defaultOriginal() const { return m_defaultOriginal; }
     const Face * getFace() const { return m_face; }
-    const Features & getFeatures(unsigned int /*charIndex*/) { assert(m_feats.size() == 1); return m_feats[0]; }
+    const Features & getFeatures(unsigned int charIndex) { assert(charIndex < m_numCharinfo); return m_feats[m_charinfo[charIndex].fid()]; }
+    // The face's interned copy of a character's features, or 0 if they
+    // have none, which a cache should take as a miss.
+    const Features * featureKey(unsigned int charIndex) const { assert(charIndex < m_numCharinfo); return m_featKeys[m_charinfo[charIndex].fid()]; }
+    size_t numFeatures() const { return m_feats.size(); }
     void bidiPass(int paradir, uint8 aMirror);
     int8 getSlotBidiClass(Slot *s) const;
     void doMirror(uint16 aMirror);
@@ -126,21 +135,33 @@ public:
 
     bool isWhitespace(const int cid) const;
     bool hasCollisionInfo() const { return (m_flags & SEG_HASCOLLISIONS) && m_collisions; }
+    void countCollisionFix() { ++m_collFixes; }
+    bool collisionBudgetSpent();
     SlotCollision *collisionInfo(const Slot *s) const { return m_collisions ? m_collisions + s->index() : 0; }
     CLASS_NEW_DELETE
 
 public:       //only used by: GrSegment* makeAndInitialize(const GrFont *font, const GrFace *face, uint32 script, const FeaturesHandle& pFeats/*must not be IsNull*/, encform enc, const void* pStart, size_t nChars, int dir);
     bool read_text(const Face *face, const Features* pFeats/*must not be NULL*/, gr_encform enc, const void*pStart, size_t nChars);
+    bool read_buffer(const Face *face, const Features* pFeats/*must not be NULL*/, gr_encform enc, const void* pStart, const void* pEnd, const void** pError);
+    bool setFeatureRun(size_t first, size_t count, const Features & feats);
+    bool read_glyphs(const Face *face, const Features* pFeats/*must not be NULL*/, const uint16 *gids, const size_t *offsets, const uint32 *usvs, size_t nGlyphs);
     void finalise(const Font *font, bool reverse=false);
+    void place(const Font *font);
+    void prefetchAdvances(const Font & font) const;
     float justify(Slot *pSlot, const Font *font, float width, enum justFlags flags, Slot *pFirst, Slot *pLast);
+    void justifyLines(const Slot * const * starts, size_t numLines, const Font *font, float width, enum justFlags flags, float *widths);
     bool initCollisions();
 
 private:
+    bool associateOverlapping(int offset, size_t num);
+    float justify(Slot *pSlot, const Font *font, float width, enum justFlags flags, Slot *pFirst, Slot *pLast, Vector<JustifyEntry> & line);
+
     Position        m_advance;          // whole segment advance
     SlotRope        m_slots;            // Vector of slot buffers
     AttributeRope   m_userAttrs;        // Vector of userAttrs buffers
     JustifyRope     m_justifies;        // Slot justification info buffers
     FeatureList     m_feats;            // feature settings referenced by charinfos in this segment
+    Vector<const Features *> m_featKeys; // interned copies of those, 0 once changed or if uninterned
     Slot          * m_freeSlots;        // linked list of free slots
     SlotJustify   * m_freeJustifies;    // Slot justification blocks free list
     CharInfo      * m_charinfo;         // character info, one per input character
@@ -151,13 +172,39 @@ private:
     Slot          * m_last;             // last slot in segment
     size_t          m_bufSize,          // how big a buffer to create when need more slots
                     m_numGlyphs,
-                    m_numCharinfo;      // size of the array and number of input characters
+                    m_numCharinfo;      // number of input characters, at most the size of the array
     int             m_defaultOriginal;  // number of whitespace chars in the string
+    uint32          m_collFixes;        // glyphs the shift collider has fixed
     int8            m_dir;
     uint8           m_flags,            // General purpose flags
                     m_passBits;         // if bit set then skip pass
+    uint32          m_matchPasses[4];   // passes any glyph ever in the segment may start a match in
 };
 
+inline
+void Segment::addMatchPasses(uint16 gid)
+{
+    const uint32 * p = m_silf->passStarts(gid);
+    for (size_t i = 0, n = m_silf->passWords(); i != n; ++i)
+        m_matchPasses[i] |= p ? p[i] : ~0U;
+}
+
+// Whether the face's collision budget for the segment is used up, counting
+// the segment against the face the first time it is.
+inline
+bool Segment::collisionBudgetSpent()
+{
+    const uint32 budget = m_face->collisionBudget();
+    if (!budget || m_collFixes < budget)
+        return false;
+    if (!(m_flags & SEG_COLLBUDGETSPENT))
+    {
+        m_flags |= SEG_COLLBUDGETSPENT;
+        m_face->countCollisionTrip();
+    }
+    return true;
+}
+
 inline
 int8 Segment::getSlotBidiClass(Slot *s) const
 {
@@ -173,13 +220,26 @@ void Segment::finalise(const Font *font, bool reverse)
 {
     if (!m_first || !m_last) return;
 
-    m_advance = positionSlots(font, m_first, m_last, m_silf->dir(), true);
+    place(font);
     //associateChars(0, m_numCharinfo);
     if (reverse && currdir() != (m_dir & 1))
         reverseSlots();
     linkClusters(m_first, m_last);
 }
 
+// Positions every slot for font, or in design units without one.  Nothing
+// before this looks at the font, so a finalised segment may be placed again
+// for another font of its face.
+inline
+void Segment::place(const Font *font)
+{
+    if (!m_first || !m_last) return;
+
+    if (font && font->batchesAdvances())
+        prefetchAdvances(*font);
+    m_advance = positionSlots(font, 0, 0, m_silf->dir(), true);
+}
+
 inline
 int32 Segment::getGlyphMetric(Slot *iSlot, uint8 metric, uint8 attrLevel, bool rtl) const {
     if (attrLevel > 0)
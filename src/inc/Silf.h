@@ -6,6 +6,7 @@
 #include "graphite2/Font.h"
 #include "inc/Main.h"
 #include "inc/Pass.h"
+#include "inc/PassCache.h"
 
 namespace graphite2 {
 
@@ -56,6 +57,8 @@ public:
     uint16 findClassIndex(uint16 cid, uint16 gid) const;
     uint16 getClassGlyph(uint16 cid, unsigned int index) const;
     uint16 findPseudo(uint32 uid) const;
+    uint16 numPseudo() const { return m_numPseudo; }
+    const Pseudo & pseudo(uint16 i) const { return m_pseudos[i]; }
     uint8 numUser() const { return m_aUser; }
     uint8 aPseudo() const { return m_aPseudo; }
     uint8 aBreak() const { return m_aBreak; }
@@ -68,6 +71,10 @@ public:
     uint8 justificationPass() const { return m_jPass; }
     uint8 bidiPass() const { return m_bPass; }
     uint8 numPasses() const { return m_numPasses; }
+    const Pass * pass(uint8 i) const { return i < m_numPasses ? m_passes + i : 0; }
+    const uint32 * passStarts(uint16 gid) const { return gid < m_numStartGlyphs ? m_passStarts + gid * passWords() : 0; }
+    size_t passWords() const { return (m_numPasses + 31) >> 5; }
+    bool enableProfile();
     uint8 maxCompPerLig() const { return m_iMaxComp; }
     uint16 numClasses() const { return m_nClass; }
     byte  flags() const { return m_flags; }
@@ -82,12 +89,15 @@ public:
 private:
     size_t readClassMap(const byte *p, size_t data_len, uint32 version, Error &e);
     template<typename T> inline uint32 readClassOffsets(const byte *&p, size_t data_len, Error &e);
+    const PassCache::Entry * activePasses(Segment & seg, SlotMap & map) const;
 
     Pass          * m_passes;
     Pseudo        * m_pseudos;
     uint32        * m_classOffsets;
     uint16        * m_classData;
     Justinfo      * m_justs;
+    uint32        * m_passStarts;   // per glyph, passes a match may begin with it
+    PassCache     * m_passCache;    // results of feature only pass constraints
     uint8           m_numPasses;
     uint8           m_numJusts;
     uint8           m_sPass, m_pPass, m_jPass, m_bPass,
@@ -96,7 +106,7 @@ private:
     uint8       m_aPseudo, m_aBreak, m_aUser, m_aBidi, m_aMirror, m_aPassBits,
                 m_iMaxComp, m_aCollision;
     uint16      m_aLig, m_numPseudo, m_nClass, m_nLinear,
-                m_gEndLine;
+                m_gEndLine, m_numStartGlyphs;
     gr_faceinfo m_silfinfo;
 
     void releaseBuffers() throw();
@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+
+// The kerning collider cuts a cluster into horizontal slices and needs the
+// edge of a glyph in each of them.  These kernels work out that edge for a
+// run of slices at once, with SSE2 or AVX2 where the processor has them, and
+// give exactly the same results whichever is used.
+
+#pragma once
+
+#include "inc/Main.h"
+#include "inc/GlyphCache.h"
+
+namespace graphite2 {
+
+class SliceEdges
+{
+public:
+    // Most slices worked out in one call.  Every kernel may write up to this
+    // many results, so it is a multiple of the widest vector.
+    enum { MAX_SLICES = 64 };
+
+    enum level { SCALAR, SSE2, AVX2, NUM_LEVELS };
+
+    // Everything a slice's edge depends on besides the box itself.
+    struct Params
+    {
+        float   sx, sy;     // glyph origin including its shift
+        float   base;       // bottom of the slices less one
+        float   width;      // height of each slice
+        float   margin;
+        int     first;      // index of the first slice wanted
+        int     count;      // number of slices, at most MAX_SLICES
+        bool    right;      // right hand edge, else the left
+    };
+
+    struct Kernel
+    {
+        // Sets res to the edge of a glyph's bounding box in each slice.
+        void (*whole)(const Params &, const BBox &, const SlantBox &, float * res);
+        // Moves res out to the edge of one of a glyph's sub boxes wherever
+        // that lies further out.
+        void (*sub)(const Params &, const BBox &, const SlantBox &, float * res);
+    };
+
+    // The fastest kernel this processor can run.
+    static const Kernel & best() throw();
+    // The kernel for a given level, or 0 if it is unavailable here.
+    static const Kernel * at(level l) throw();
+
+    // Clears res before a glyph's sub boxes are merged into it.  This covers
+    // the lanes a kernel works on beyond p.count too.
+    static void reset(const Params & p, float * res) throw();
+};
+
+inline
+void SliceEdges::reset(const Params & p, float * res) throw()
+{
+    const float v = p.right ? (float)-1e38 : (float)1e38;
+    for (float * const e = res + ((p.count + 7) & ~7); res != e; ++res)
+        *res = v;
+}
+
+} // namespace graphite2
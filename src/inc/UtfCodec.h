@@ -6,6 +6,11 @@
 #include <cstdlib>
 #include "inc/Main.h"
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#define GRAPHITE2_UTF_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace graphite2 {
 
 typedef uint32  uchar_t;
@@ -18,6 +23,12 @@ struct _utf_codec
     static void     put(codeunit_t * cp, const uchar_t , int8 & len) throw();
     static uchar_t  get(const codeunit_t * cp, int8 & len) throw();
     static bool     validate(const codeunit_t * s, const codeunit_t * const e) throw();
+    // How many code units from s on, short of e, are each a whole character
+    // other than nul, so need no decoding.  This may stop a little short.
+    static size_t   plain_run(const codeunit_t * s, const codeunit_t * const e) throw();
+    // How many code units from s on, short of e, are printable ASCII, 0x20
+    // to 0x7E.
+    static size_t   printable_run(const codeunit_t * s, const codeunit_t * const e) throw();
 };
 
 
@@ -47,6 +58,31 @@ public:
     {
         return s <= e;
     }
+
+    inline
+    static size_t plain_run(const codeunit_t * s, const codeunit_t * const e) throw()
+    {
+        const codeunit_t * p = s;
+        while (p < e && *p && *p < limit) ++p;
+        return p - s;
+    }
+
+    inline
+    static size_t printable_run(const codeunit_t * s, const codeunit_t * const e) throw()
+    {
+        const codeunit_t * p = s;
+#if defined GRAPHITE2_UTF_SSE2
+        // Four units at a time, those from 0x80000000 up comparing negative.
+        const __m128i lo = _mm_set1_epi32(0x1F), hi = _mm_set1_epi32(0x7F);
+        for (; e - p >= 4; p += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi32(v, lo), _mm_cmplt_epi32(v, hi))) != 0xFFFF) break;
+        }
+#endif
+        while (p < e && *p > 0x1F && *p < 0x7F) ++p;
+        return p - s;
+    }
 };
 
 
@@ -93,6 +129,45 @@ public:
         const uint32 u = *(e-1); // Get the last codepoint
         return (u < 0xD800 || u > 0xDBFF);
     }
+
+    inline
+    static size_t plain_run(const codeunit_t * s, const codeunit_t * const e) throw()
+    {
+        const codeunit_t * p = s;
+        if (p == e || !*p || (*p & 0xF800) == 0xD800) return 0;
+#if defined GRAPHITE2_UTF_SSE2
+        // Eight units at a time, none of them nul or a surrogate.
+        const __m128i zero = _mm_setzero_si128(),
+                      mask = _mm_set1_epi16(short(0xF800)),
+                      surrogate = _mm_set1_epi16(short(0xD800));
+        for (; e - p >= 8; p += 8)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            const __m128i stop = _mm_or_si128(_mm_cmpeq_epi16(v, zero),
+                                              _mm_cmpeq_epi16(_mm_and_si128(v, mask), surrogate));
+            if (_mm_movemask_epi8(stop)) break;
+        }
+#endif
+        while (p < e && *p && (*p & 0xF800) != 0xD800) ++p;
+        return p - s;
+    }
+
+    inline
+    static size_t printable_run(const codeunit_t * s, const codeunit_t * const e) throw()
+    {
+        const codeunit_t * p = s;
+#if defined GRAPHITE2_UTF_SSE2
+        // Eight units at a time, those from 0x8000 up comparing negative.
+        const __m128i lo = _mm_set1_epi16(0x1F), hi = _mm_set1_epi16(0x7F);
+        for (; e - p >= 8; p += 8)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi16(v, lo), _mm_cmplt_epi16(v, hi))) != 0xFFFF) break;
+        }
+#endif
+        while (p < e && *p > 0x1F && *p < 0x7F) ++p;
+        return p - s;
+    }
 };
 
 
@@ -160,6 +235,40 @@ public:
         return true;
     }
 
+    inline
+    static size_t plain_run(const codeunit_t * s, const codeunit_t * const e) throw()
+    {
+        const codeunit_t * p = s;
+        if (p == e || !*p || *p >= 0x80) return 0;
+#if defined GRAPHITE2_UTF_SSE2
+        // Sixteen bytes at a time, all of them ASCII and none nul.
+        const __m128i zero = _mm_setzero_si128();
+        for (; e - p >= 16; p += 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            if (_mm_movemask_epi8(_mm_or_si128(v, _mm_cmpeq_epi8(v, zero)))) break;
+        }
+#endif
+        while (p < e && *p && *p < 0x80) ++p;
+        return p - s;
+    }
+
+    inline
+    static size_t printable_run(const codeunit_t * s, const codeunit_t * const e) throw()
+    {
+        const codeunit_t * p = s;
+#if defined GRAPHITE2_UTF_SSE2
+        // Sixteen bytes at a time, those from 0x80 up comparing negative.
+        const __m128i lo = _mm_set1_epi8(0x1F), hi = _mm_set1_epi8(0x7F);
+        for (; e - p >= 16; p += 16)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            if (_mm_movemask_epi8(_mm_and_si128(_mm_cmpgt_epi8(v, lo), _mm_cmplt_epi8(v, hi))) != 0xFFFF) break;
+        }
+#endif
+        while (p < e && *p > 0x1F && *p < 0x7F) ++p;
+        return p - s;
+    }
 };
 
 
@@ -204,6 +313,16 @@ public:
 
     bool error() const throw()  { return sl < 1; }
     bool validate(const _utf_iterator & e)  { return codec::validate(cp, e.cp); }
+    // Steps over any characters ahead, short of e, that need no decoding,
+    // returning how many there were.  It only looks if the last character
+    // was plain too, as one needing decoding is seldom followed by a run.
+    size_t skip_plain(const _utf_iterator & e) throw()
+    {
+        if (sl != 1) return 0;
+        const size_t n = codec::plain_run(cp, e.cp);
+        cp += n; sl = 1;
+        return n;
+    }
 };
 
 template <typename C>
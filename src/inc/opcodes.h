@@ -37,6 +37,7 @@
 //        isf       = The first positioned slot
 //        isl       = The last positioned slot
 //        ip        = The current instruction pointer
+//        skipped   = Instructions jumped over so far, for counting those run
 //        endPos    = Position of advance of last cluster
 //        dir       = writing system directionality of the font
 
@@ -357,6 +358,7 @@ STARTOP(cntxt_item)
     {
         ip += iskip;
         dp += dskip;
+        skipped += iskip;
         push(true);
     }
 ENDOP
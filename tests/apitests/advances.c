@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* usage: ./advances fontfile.ttf string
+   Shapes the string with made up hinted advances, given once a glyph at a
+   time and once in batches, and checks both place the glyphs the same and
+   that the batches ask for each glyph only once. */
+
+struct counts
+{
+    int single;     /* calls for one advance */
+    int batches;    /* calls for many */
+    size_t glyphs;  /* glyphs asked for in those */
+    int repeats;    /* glyphs asked for more than once */
+    unsigned char seen[65536];
+};
+
+static float hinted(gr_uint16 gid)
+{
+    return (float)(gid % 7) + 5.f;
+}
+
+static float single_advance(const void *handle, gr_uint16 gid)
+{
+    ((struct counts *)handle)->single++;
+    return hinted(gid);
+}
+
+static void batch_advances(const void *handle, const gr_uint16 *gids, size_t n, float *advances)
+{
+    struct counts *c = (struct counts *)handle;
+    size_t i;
+    c->batches++;
+    c->glyphs += n;
+    for (i = 0; i < n; ++i)
+    {
+        c->repeats += c->seen[gids[i]];
+        c->seen[gids[i]] = 1;
+        advances[i] = hinted(gids[i]);
+    }
+}
+
+static gr_segment *shape(gr_font *font, gr_face *face, const char *text)
+{
+    size_t numChars = gr_count_unicode_characters(gr_utf8, text, NULL, NULL);
+    return gr_make_seg(font, face, 0, 0, gr_utf8, text, numChars, 0);
+}
+
+int main(int argc, char **argv)
+{
+    static struct counts one, many;
+    gr_font_ops oneOps, manyOps;
+    gr_font *oneFont, *manyFont;
+    gr_segment *oneSeg, *manySeg, *again;
+    const gr_slot *s, *t;
+    gr_face *face;
+
+    if (argc < 3) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+
+    memset(&oneOps, 0, sizeof oneOps);
+    oneOps.size = sizeof oneOps;
+    oneOps.glyph_advance_x = &single_advance;
+    memset(&manyOps, 0, sizeof manyOps);
+    manyOps.size = sizeof manyOps;
+    manyOps.glyph_advances_x = &batch_advances;
+    oneFont = gr_make_font_with_ops(12, &one, &oneOps, face);
+    manyFont = gr_make_font_with_ops(12, &many, &manyOps, face);
+    if (!oneFont || !manyFont) return 2;
+
+    oneSeg = shape(oneFont, face, argv[2]);
+    manySeg = shape(manyFont, face, argv[2]);
+    if (!oneSeg || !manySeg) return 3;
+
+    for (s = gr_seg_first_slot(oneSeg), t = gr_seg_first_slot(manySeg); s && t;
+         s = gr_slot_next_in_segment(s), t = gr_slot_next_in_segment(t))
+    {
+        if (gr_slot_gid(s) != gr_slot_gid(t)
+            || gr_slot_origin_X(s) != gr_slot_origin_X(t)
+            || gr_slot_advance_X(s, face, oneFont) != gr_slot_advance_X(t, face, manyFont))
+            return 4;
+    }
+    if (s || t || gr_seg_advance_X(oneSeg) != gr_seg_advance_X(manySeg)) return 5;
+
+    /* Every glyph came in the one batch, just once, with none left over. */
+    if (many.batches != 1 || many.repeats || many.single || many.glyphs != (size_t)one.single) return 6;
+
+    /* A second segment needs no more advances at all. */
+    again = shape(manyFont, face, argv[2]);
+    if (!again || many.batches != 1) return 7;
+
+    printf("%lu advances in %d batch\n", (unsigned long)many.glyphs, many.batches);
+
+    gr_seg_destroy(oneSeg);
+    gr_seg_destroy(manySeg);
+    gr_seg_destroy(again);
+    gr_font_destroy(oneFont);
+    gr_font_destroy(manyFont);
+    gr_face_destroy(face);
+    return 0;
+}
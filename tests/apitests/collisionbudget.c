@@ -0,0 +1,113 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* usage: ./collisionbudget fontfile.ttf budget
+   Shapes random runs of Arabic letters piled with marks, which make a lot of
+   collision work, and checks a collision budget holds for each of them. */
+
+#define NUM_RUNS 150
+#define MAX_LEN 48
+
+static unsigned int seed = 1;
+
+static unsigned int rnd(unsigned int n)
+{
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) & 0xFFFF) % n;
+}
+
+static size_t make_run(gr_uint32 *text)
+{
+    size_t len = 4 + rnd(MAX_LEN - 4), i;
+    for (i = 0; i < len; ++i)
+        text[i] = rnd(3) ? 0x0628 + rnd(0x064A - 0x0628 + 1)    /* letters */
+                         : 0x064B + rnd(0x0652 - 0x064B + 1);   /* marks */
+    return len;
+}
+
+static size_t collision_fixes(const gr_face *face)
+{
+    gr_profile_counts counts;
+    size_t fixes = 0;
+    unsigned int pass;
+    for (pass = 0; gr_face_profile(face, 0, pass, -1, &counts) >= 0; ++pass)
+        fixes += counts.collision_fixes;
+    return fixes;
+}
+
+/* Shapes text with the given budget, returning the glyph fixes it took, or
+   -1 if the segment could not be made. */
+static long shape(gr_face *face, gr_font *font, unsigned int budget,
+                  const gr_uint32 *text, size_t len, float *pos, unsigned int *numGlyphs)
+{
+    const size_t before = collision_fixes(face);
+    const gr_slot *s;
+    gr_segment *seg;
+    unsigned int n = 0;
+
+    gr_face_set_collision_budget(face, budget);
+    seg = gr_make_seg(font, face, 0, 0, gr_utf32, text, len, 1);
+    if (!seg) return -1;
+    for (s = gr_seg_first_slot(seg); s && n < 2 * MAX_LEN; s = gr_slot_next_in_segment(s), ++n)
+    {
+        pos[2 * n] = gr_slot_origin_X(s);
+        pos[2 * n + 1] = gr_slot_origin_Y(s);
+    }
+    *numGlyphs = n;
+    gr_seg_destroy(seg);
+    return (long)(collision_fixes(face) - before);
+}
+
+int main(int argc, char **argv)
+{
+    gr_uint32 text[MAX_LEN];
+    float full[4 * MAX_LEN], capped[4 * MAX_LEN], first[4 * MAX_LEN];
+    unsigned int budget, nFull, nCapped, nFirst;
+    size_t trips = 0, over = 0;
+    gr_face *face;
+    gr_font *font;
+    int run;
+
+    if (argc < 3) return 1;
+    budget = (unsigned int)atoi(argv[2]);
+    if (budget == 0) return 1;
+    face = gr_make_file_face(argv[1], gr_face_preloadAll | gr_face_collectProfile);
+    if (!face) return 1;
+    font = gr_make_font(12, face);
+    if (!font) return 2;
+
+    for (run = 0; run < NUM_RUNS; ++run)
+    {
+        const size_t len = make_run(text);
+        const long fixes = shape(face, font, 0, text, len, full, &nFull);
+        const long firstFixes = shape(face, font, 1, text, len, first, &nFirst);
+        const size_t tripsBefore = gr_face_collision_budget_trips(face);
+        const long cappedFixes = shape(face, font, budget, text, len, capped, &nCapped);
+        const int tripped = gr_face_collision_budget_trips(face) != tripsBefore;
+
+        if (fixes < 0 || firstFixes < 0 || cappedFixes < 0) return 3;
+        /* Past the budget only the first fix of each glyph is still made. */
+        if ((unsigned long)cappedFixes > budget + (unsigned long)firstFixes) return 4;
+        /* A segment within its budget comes out just as it would without one. */
+        if ((unsigned long)fixes <= budget
+            && (tripped || nCapped != nFull || memcmp(capped, full, nFull * 2 * sizeof(float))))
+            return 5;
+        /* A trip means there was work the budget stopped. */
+        if (tripped && (unsigned long)fixes <= budget) return 6;
+        trips += tripped;
+        over += (unsigned long)fixes > budget;
+    }
+
+    printf("%lu of %d runs over a budget of %u, %lu tripped\n",
+           (unsigned long)over, NUM_RUNS, budget, (unsigned long)trips);
+    /* The runs are meant to be hard enough to trip it. */
+    if (trips == 0) return 7;
+
+    gr_font_destroy(font);
+    gr_face_destroy(face);
+    return 0;
+}
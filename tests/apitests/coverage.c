@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* usage: ./coverage string fontfile.ttf...
+   Checks each font's coverage, with its cmap cached and not, against asking
+   a character at a time.  Then picks a font for each character of the string,
+   in each encoding, and checks that against doing so a character at a time. */
+
+#define MAX_FACES 8
+#define MAX_CHARS 256
+
+/* Whether any of the 32 characters in word w, or in those either side of
+   it, are in the set. */
+static int near_covered(const gr_uint32 *bits, gr_uint32 limit, gr_uint32 w)
+{
+    const gr_uint32 words = limit / 32;
+    return (w < words && bits[w]) || (w > 0 && w - 1 < words && bits[w - 1])
+        || (w + 1 < words && bits[w + 1]);
+}
+
+static int check_coverage(const gr_face *face)
+{
+    gr_uint32 limit, w, usv;
+    const gr_uint32 *bits = gr_face_coverage(face, &limit);
+    if (!bits || limit % 32 || limit > 0x110000) return 1;
+    /* Every character around those in the set, and elsewhere just one in
+       every so many, to keep it quick. */
+    for (w = 0; w < 0x110000 / 32; ++w)
+    {
+        const int all = near_covered(bits, limit, w);
+        if (!all && w % 8) continue;
+        for (usv = w * 32 + (all ? 0 : w % 31); usv < w * 32 + 32; usv += all ? 1 : 32)
+        {
+            const int covered = usv < limit && (bits[usv >> 5] >> (usv & 31)) & 1;
+            if (covered != gr_face_is_char_supported(face, usv, 0)) return 1;
+        }
+    }
+    return 0;
+}
+
+/* Decodes well formed UTF-8, returning the number of characters. */
+static size_t decode(const char *s, gr_uint32 *usvs)
+{
+    const unsigned char *p = (const unsigned char *)s;
+    size_t n = 0;
+    while (*p && n < MAX_CHARS)
+    {
+        int len = *p < 0x80 ? 1 : *p < 0xE0 ? 2 : *p < 0xF0 ? 3 : 4;
+        gr_uint32 u = *p++ & (0xFF >> (len + (len > 1)));
+        while (--len) u = (u << 6) | (*p++ & 0x3F);
+        usvs[n++] = u;
+    }
+    return n;
+}
+
+static int check_fallback(const gr_face **faces, size_t nFaces, enum gr_encform enc,
+                          const void *text, size_t numChars, const gr_uint32 *usvs)
+{
+    int found[MAX_CHARS];
+    size_t i, f;
+    if (gr_faces_first_supporting(faces, nFaces, enc, text, numChars, found) != numChars) return 1;
+    for (i = 0; i < numChars; ++i)
+    {
+        int want = -1;
+        for (f = 0; f < nFaces && want < 0; ++f)
+            if (faces[f] && gr_face_is_char_supported(faces[f], usvs[i], 0)) want = (int)f;
+        if (found[i] != want) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const gr_face *faces[MAX_FACES + 1];
+    gr_uint32 usvs[MAX_CHARS];
+    gr_uint16 utf16[2 * MAX_CHARS];
+    size_t nFaces = 0, numChars, n16 = 0, i;
+
+    if (argc < 3) return 1;
+    for (i = 2; i < (size_t)argc && nFaces < MAX_FACES; ++i)
+    {
+        gr_face *cached = gr_make_file_face(argv[i], gr_face_cacheCmap);
+        gr_face *direct = gr_make_file_face(argv[i], 0);
+        if (!cached || !direct) return 2;
+        if (check_coverage(cached) || check_coverage(direct)) return 3;
+        gr_face_destroy(direct);
+        faces[nFaces++] = cached;
+    }
+
+    numChars = decode(argv[1], usvs);
+    for (i = 0; i < numChars; ++i)
+    {
+        if (usvs[i] < 0x10000)
+            utf16[n16++] = (gr_uint16)usvs[i];
+        else
+        {
+            utf16[n16++] = (gr_uint16)(0xD7C0 + (usvs[i] >> 10));
+            utf16[n16++] = (gr_uint16)(0xDC00 + (usvs[i] & 0x3FF));
+        }
+    }
+
+    if (check_fallback(faces, nFaces, gr_utf8, argv[1], numChars, usvs)
+        || check_fallback(faces, nFaces, gr_utf16, utf16, numChars, usvs)
+        || check_fallback(faces, nFaces, gr_utf32, usvs, numChars, usvs))
+        return 4;
+    /* A missing face in the list just supports nothing. */
+    memmove(faces + 1, faces, nFaces * sizeof(faces[0]));
+    faces[0] = NULL;
+    if (check_fallback(faces, nFaces + 1, gr_utf8, argv[1], numChars, usvs)) return 5;
+    printf("%lu faces, %lu characters\n", (unsigned long)nFaces, (unsigned long)numChars);
+
+    for (i = 1; i <= nFaces; ++i)
+        gr_face_destroy((gr_face *)faces[i]);
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Font.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* usage: ./craftedcmap fontfile.ttf
+   Gives the font a cmap whose format 4 segments all start at 0, and so
+   overlap, and whose format 12 groups are out of order and overlap too, then
+   checks a face reading it in native byte order works out its coverage in
+   good time and agrees with gr_face_is_char_supported on every character. */
+
+#define NUM_SEGS 8000
+#define NUM_GROUPS 4000
+
+typedef struct
+{
+    unsigned char *font;
+    size_t         fontLen;
+    unsigned char *cmap;
+    size_t         cmapLen;
+} tables;
+
+static unsigned int peek32(const unsigned char *p)
+{
+    return (unsigned int)p[0] << 24 | (unsigned int)p[1] << 16 | (unsigned int)p[2] << 8 | p[3];
+}
+
+static unsigned char *put16(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char)(v >> 8); p[1] = (unsigned char)v;
+    return p + 2;
+}
+
+static unsigned char *put32(unsigned char *p, unsigned int v)
+{
+    return put16(put16(p, v >> 16), v & 0xFFFF);
+}
+
+static const void *get_table(const void *handle, unsigned int name, size_t *len)
+{
+    const tables *t = (const tables *)handle;
+    unsigned int i, numTables;
+    if (name == gr_str_to_tag("cmap"))
+    {
+        *len = t->cmapLen;
+        return t->cmap;
+    }
+    if (t->fontLen < 12) return NULL;
+    numTables = (unsigned int)t->font[4] << 8 | t->font[5];
+    for (i = 0; i < numTables && 12 + 16 * (i + 1) <= t->fontLen; ++i)
+    {
+        const unsigned char *d = t->font + 12 + 16 * i;
+        const unsigned int offset = peek32(d + 8), length = peek32(d + 12);
+        if (peek32(d) != name || offset > t->fontLen || length > t->fontLen - offset) continue;
+        *len = length;
+        return t->font + offset;
+    }
+    *len = 0;
+    return NULL;
+}
+
+/* A cmap with a 3/1 format 4 subtable and a 3/10 format 12 one. */
+static unsigned char *make_cmap(size_t *len)
+{
+    const size_t len4 = 16 + 8 * NUM_SEGS, len12 = 16 + 12 * NUM_GROUPS;
+    unsigned char *const cmap = (unsigned char *)malloc(20 + len4 + len12), *p;
+    unsigned int i;
+    if (!cmap) return NULL;
+    p = put16(put16(cmap, 0), 2);
+    p = put32(put16(put16(p, 3), 1), 20);
+    p = put32(put16(put16(p, 3), 10), (unsigned int)(20 + len4));
+
+    /* Ends rise to 0xFFFF, but every segment starts at 0, mapping each
+       character to the glyph one past it. */
+    p = put16(put16(put16(p, 4), (unsigned int)len4), 0);
+    p = put16(put16(put16(put16(p, 2 * NUM_SEGS), 0), 0), 0);
+    for (i = 0; i != NUM_SEGS; ++i)
+        p = put16(p, i + 1 == NUM_SEGS ? 0xFFFF : 0xFFFF - NUM_SEGS + i);
+    p = put16(p, 0);
+    for (i = 0; i != NUM_SEGS; ++i) p = put16(p, i + 1 == NUM_SEGS ? 0xFFFF : 0);
+    for (i = 0; i != NUM_SEGS; ++i) p = put16(p, 1);
+    for (i = 0; i != NUM_SEGS; ++i) p = put16(p, 0);
+
+    /* Groups last to first, each reaching past the end of Unicode. */
+    p = put32(put32(put16(put16(p, 12), 0), (unsigned int)len12), 0);
+    p = put32(p, NUM_GROUPS);
+    for (i = NUM_GROUPS; i--; )
+        p = put32(put32(put32(p, 0x10000 + 0x100 * i), i ? 0x10FFFF : 0xFFFFFFFF), 1 + i);
+
+    *len = (size_t)(p - cmap);
+    return cmap;
+}
+
+int main(int argc, char **argv)
+{
+    const gr_face_ops ops = { sizeof(gr_face_ops), &get_table, NULL };
+    const gr_uint32 *bits;
+    gr_uint32 limit, usv;
+    size_t numChars = 0;
+    gr_face *face;
+    tables t;
+    FILE *f;
+
+    if (argc < 2) return 1;
+    f = fopen(argv[1], "rb");
+    if (!f || fseek(f, 0, SEEK_END) || (long)(t.fontLen = (size_t)ftell(f)) < 0) return 1;
+    rewind(f);
+    t.font = (unsigned char *)malloc(t.fontLen);
+    if (!t.font || fread(t.font, 1, t.fontLen, f) != t.fontLen) return 1;
+    fclose(f);
+    t.cmap = make_cmap(&t.cmapLen);
+    if (!t.cmap) return 1;
+
+    face = gr_make_face_with_ops(&t, &ops, gr_face_nativeCmap);
+    if (!face) return 2;
+    bits = gr_face_coverage(face, &limit);
+    if (!bits || limit != 0x110000) return 3;
+
+    for (usv = 0; usv < 0x110000; ++usv)
+    {
+        const int covered = (bits[usv >> 5] >> (usv & 31)) & 1;
+        if (covered != (gr_face_is_char_supported(face, usv, 0) != 0)) return 4;
+        numChars += covered;
+    }
+    /* All map to a glyph bar 0xFFFE and 0xFFFF, past the last of the rising
+       ends, and the 16 where the glyph id of the first group, which the rest
+       overlap, wraps round to 0. */
+    if (numChars != 0x110000 - 18) return 5;
+    printf("%lu characters covered\n", (unsigned long)numChars);
+
+    gr_face_destroy(face);
+    free(t.cmap);
+    free(t.font);
+    return 0;
+}
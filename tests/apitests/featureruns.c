@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* usage: ./featureruns fontfile.ttf featuretag start length string
+   Shapes the string with the feature turned on for a run of it, and checks
+   each glyph is the one from shaping the whole string with the feature as
+   it is for that character. The font must map each character to a glyph. */
+
+static gr_segment *make(gr_font *font, gr_face *face, const char *text, size_t numChars,
+                        const gr_feature_val *feats, const gr_feature_run *runs, size_t numRuns)
+{
+    return gr_make_seg_with_feature_runs(font, face, 0, feats, gr_utf8, text, numChars, 0, runs, numRuns);
+}
+
+int main(int argc, char **argv)
+{
+    const gr_feature_ref *fref;
+    gr_feature_val *off, *on;
+    gr_feature_run run;
+    gr_segment *offSeg, *onSeg, *runSeg, *plainSeg;
+    const gr_slot *s, *o, *n, *p;
+    size_t numChars, i;
+    int changed = 0;
+    gr_face *face;
+    gr_font *font;
+
+    if (argc < 6) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+    font = gr_make_font(16, face);
+    if (!font) return 2;
+    fref = gr_face_find_fref(face, gr_str_to_tag(argv[2]));
+    off = gr_face_featureval_for_lang(face, 0);
+    on = gr_face_featureval_for_lang(face, 0);
+    if (!fref || !off || !on || !gr_fref_set_feature_value(fref, 1, on)) return 3;
+    run.start = (size_t)atoi(argv[3]);
+    run.length = (size_t)atoi(argv[4]);
+    run.features = on;
+
+    numChars = gr_count_unicode_characters(gr_utf8, argv[5], NULL, NULL);
+    offSeg = make(font, face, argv[5], numChars, off, NULL, 0);
+    onSeg = make(font, face, argv[5], numChars, on, NULL, 0);
+    runSeg = make(font, face, argv[5], numChars, off, &run, 1);
+    plainSeg = gr_make_seg(font, face, 0, off, gr_utf8, argv[5], numChars, 0);
+    if (!offSeg || !onSeg || !runSeg || !plainSeg) return 4;
+    if (gr_seg_n_slots(runSeg) != numChars || gr_seg_n_slots(offSeg) != numChars
+        || gr_seg_n_slots(onSeg) != numChars)
+        return 5;
+
+    for (i = 0, s = gr_seg_first_slot(runSeg), o = gr_seg_first_slot(offSeg),
+                n = gr_seg_first_slot(onSeg), p = gr_seg_first_slot(plainSeg);
+         s && o && n && p;
+         ++i, s = gr_slot_next_in_segment(s), o = gr_slot_next_in_segment(o),
+              n = gr_slot_next_in_segment(n), p = gr_slot_next_in_segment(p))
+    {
+        const int inRun = i >= run.start && i < run.start + run.length;
+        if (gr_slot_gid(s) != gr_slot_gid(inRun ? n : o)) return 6;
+        /* With no runs the segment is just as gr_make_seg makes it. */
+        if (gr_slot_gid(o) != gr_slot_gid(p) || gr_slot_origin_X(o) != gr_slot_origin_X(p)) return 7;
+        changed += inRun && gr_slot_gid(n) != gr_slot_gid(o);
+    }
+    /* The feature must make some difference for the test to mean anything. */
+    if (!changed) return 8;
+    printf("%d glyphs changed by the run\n", changed);
+
+    gr_seg_destroy(offSeg);
+    gr_seg_destroy(onSeg);
+    gr_seg_destroy(runSeg);
+    gr_seg_destroy(plainSeg);
+    gr_featureval_destroy(off);
+    gr_featureval_destroy(on);
+    gr_font_destroy(font);
+    gr_face_destroy(face);
+    return 0;
+}
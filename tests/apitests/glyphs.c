@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "segcompare.h"
+
+/* usage: ./glyphs fontfile.ttf string
+   Shapes the string, then shapes the glyphs that came out of that again as
+   though mapped by the caller, and checks both come out the same. */
+
+#define MAX_GLYPHS 256
+
+int main(int argc, char **argv)
+{
+    gr_uint16 gids[MAX_GLYPHS];
+    size_t offsets[MAX_GLYPHS];
+    gr_uint32 chars[MAX_GLYPHS];
+    const gr_slot *s;
+    gr_segment *textSeg, *glyphSeg;
+    size_t numChars, n = 0;
+    gr_face *face;
+    gr_font *font;
+
+    if (argc < 3) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+    font = gr_make_font(16, face);
+    if (!font) return 2;
+    numChars = gr_count_unicode_characters(gr_utf8, argv[2], NULL, NULL);
+    textSeg = gr_make_seg(font, face, 0, 0, gr_utf8, argv[2], numChars, 0);
+    if (!textSeg) return 3;
+
+    for (s = gr_seg_first_slot(textSeg); s && n < MAX_GLYPHS; s = gr_slot_next_in_segment(s), ++n)
+    {
+        const gr_char_info *ci = gr_seg_cinfo(textSeg, gr_slot_original(s));
+        gids[n] = gr_slot_gid(s);
+        offsets[n] = gr_cinfo_base(ci) + 1000;
+        chars[n] = gr_cinfo_unicode_char(ci);
+    }
+    glyphSeg = gr_make_seg_from_glyphs(font, face, 0, 0, gids, offsets, chars, n, 0);
+    if (!glyphSeg) return 4;
+    if (gr_seg_n_slots(glyphSeg) != n || gr_seg_n_cinfo(glyphSeg) != n) return 5;
+
+    if (seg_differ(textSeg, glyphSeg)) return 6;
+
+    /* The caller's offsets and characters come back as given. */
+    for (n = 0; n < gr_seg_n_cinfo(glyphSeg); ++n)
+    {
+        const gr_char_info *ci = gr_seg_cinfo(glyphSeg, (unsigned int)n);
+        if (gr_cinfo_base(ci) != offsets[n] || gr_cinfo_unicode_char(ci) != chars[n]) return 7;
+    }
+    printf("%lu glyphs shaped the same\n", (unsigned long)n);
+
+    gr_seg_destroy(textSeg);
+    gr_seg_destroy(glyphSeg);
+    gr_font_destroy(font);
+    gr_face_destroy(face);
+    return 0;
+}
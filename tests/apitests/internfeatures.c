@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "segcompare.h"
+
+/* usage: ./internfeatures fontfile.ttf featuretag string
+   Interns feature values with a face and checks equal values give the same
+   copy and hash, that different ones do not, and that a segment shapes the
+   same from an interned copy as from the values it came from. */
+
+int main(int argc, char **argv)
+{
+    const gr_feature_val *def, *dflt, *withFeat, *again;
+    const gr_feature_ref *fref;
+    gr_feature_val *feats;
+    gr_segment *seg1, *seg2;
+    size_t numChars;
+    gr_face *face;
+    gr_font *font;
+    int numSets = 0;
+    gr_uint16 i;
+
+    if (argc < 4) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+    font = gr_make_font(16, face);
+    if (!font) return 2;
+    fref = gr_face_find_fref(face, gr_str_to_tag(argv[2]));
+    feats = gr_face_featureval_for_lang(face, 0);
+    if (!fref || !feats) return 3;
+
+    /* The defaults interned by hand and as asked for are the same copy. */
+    def = gr_face_intern_featureval(face, feats);
+    dflt = gr_face_default_featureval(face, 0);
+    if (!def || def != dflt || def == feats) return 4;
+    if (gr_featureval_hash(def) != gr_featureval_hash(feats)) return 5;
+
+    /* Changing a value makes a different set, and changing it back finds
+       the first again. */
+    if (!gr_fref_set_feature_value(fref, 1, feats)) return 3;
+    withFeat = gr_face_intern_featureval(face, feats);
+    if (!withFeat || withFeat == def || gr_fref_feature_value(fref, withFeat) != 1) return 6;
+    if (gr_featureval_hash(withFeat) == gr_featureval_hash(def)) return 7;
+    if (!gr_fref_set_feature_value(fref, 0, feats)) return 3;
+    again = gr_face_intern_featureval(face, feats);
+    if (again != def) return 8;
+
+    /* Every value of every feature interns as a set of its own. */
+    for (i = 0; i < gr_face_n_fref(face); ++i)
+    {
+        gr_feature_val *f = gr_face_featureval_for_lang(face, 0);
+        const gr_feature_ref *r = gr_face_fref(face, i);
+        const gr_feature_val *one;
+        if (!f || gr_fref_n_values(r) < 2 || !gr_fref_set_feature_value(r, (gr_uint16)gr_fref_value(r, 1), f)
+            || gr_fref_feature_value(r, f) == gr_fref_feature_value(r, def))
+        {
+            gr_featureval_destroy(f);
+            continue;
+        }
+        one = gr_face_intern_featureval(face, f);
+        if (one == def || (one && one != gr_face_intern_featureval(face, f))) return 9;
+        numSets += one != NULL;
+        gr_featureval_destroy(f);
+    }
+
+    numChars = gr_count_unicode_characters(gr_utf8, argv[3], NULL, NULL);
+    if (!gr_fref_set_feature_value(fref, 1, feats)) return 3;
+    seg1 = gr_make_seg(font, face, 0, feats, gr_utf8, argv[3], numChars, 0);
+    seg2 = gr_make_seg(font, face, 0, withFeat, gr_utf8, argv[3], numChars, 0);
+    if (!seg1 || !seg2) return 10;
+    if (seg_differ(seg1, seg2)) return 11;
+    printf("%d feature sets interned\n", numSets + 2);
+
+    gr_seg_destroy(seg1);
+    gr_seg_destroy(seg2);
+    gr_featureval_destroy(feats);
+    gr_font_destroy(font);
+    gr_face_destroy(face);
+    return 0;
+}
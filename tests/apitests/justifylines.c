@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* usage: ./justifylines fontfile.ttf width string
+   Breaks the string into lines twice over, justifies one set a line at a time
+   and the other in a single call, and checks they come out the same. */
+
+#define MAX_LINES 64
+
+/* Breaks seg into lines of the given width at spaces, returning how many. */
+static int break_lines(gr_segment *seg, float width, const gr_slot **starts)
+{
+    const gr_slot *s;
+    float lineend = width;
+    int n = 0;
+
+    starts[n++] = gr_seg_first_slot(seg);
+    for (s = starts[0]; s && n < MAX_LINES; s = gr_slot_next_in_segment(s))
+    {
+        if (gr_slot_origin_X(s) > lineend)
+        {
+            const gr_slot *t = s;
+            while (t && t != starts[n - 1]
+                   && gr_cinfo_unicode_char(gr_seg_cinfo(seg, gr_slot_before(t))) != ' ')
+                t = gr_slot_prev_in_segment(t);
+            if (!t || t == starts[n - 1]) continue;
+            starts[n++] = t;
+            gr_slot_linebreak_before((gr_slot *)t);
+            lineend = gr_slot_origin_X(t) + width;
+            s = t;
+        }
+    }
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    const gr_slot *oneStarts[MAX_LINES], *allStarts[MAX_LINES], *s, *t;
+    float oneWidths[MAX_LINES], allWidths[MAX_LINES];
+    gr_segment *oneSeg, *allSeg;
+    size_t numChars;
+    float width;
+    int numLines, i;
+    gr_face *face;
+    gr_font *font;
+
+    if (argc < 4) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+    font = gr_make_font(16, face);
+    if (!font) return 2;
+    width = (float)atof(argv[2]);
+    numChars = gr_count_unicode_characters(gr_utf8, argv[3], NULL, NULL);
+    oneSeg = gr_make_seg(font, face, 0, 0, gr_utf8, argv[3], numChars, 0);
+    allSeg = gr_make_seg(font, face, 0, 0, gr_utf8, argv[3], numChars, 0);
+    if (!oneSeg || !allSeg) return 3;
+
+    numLines = break_lines(oneSeg, width, oneStarts);
+    if (break_lines(allSeg, width, allStarts) != numLines || numLines < 2) return 4;
+
+    for (i = 0; i < numLines; ++i)
+        oneWidths[i] = gr_seg_justify(oneSeg, oneStarts[i], font, width, 0, NULL, NULL);
+    gr_seg_justify_lines(allSeg, allStarts, numLines, font, width, 0, allWidths);
+
+    for (i = 0; i < numLines; ++i)
+    {
+        if (oneWidths[i] != allWidths[i]) return 5;
+        for (s = oneStarts[i], t = allStarts[i]; s && t;
+             s = gr_slot_next_in_segment(s), t = gr_slot_next_in_segment(t))
+        {
+            if (gr_slot_gid(s) != gr_slot_gid(t)
+                || gr_slot_origin_X(s) != gr_slot_origin_X(t)
+                || gr_slot_origin_Y(s) != gr_slot_origin_Y(t))
+                return 6;
+        }
+        if (s || t) return 7;
+    }
+    printf("%d lines justified to %.0f\n", numLines, width);
+
+    gr_seg_destroy(oneSeg);
+    gr_seg_destroy(allSeg);
+    gr_font_destroy(font);
+    gr_face_destroy(face);
+    return 0;
+}
@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "segcompare.h"
+
+/* usage: ./nativecmap fontfile.ttf
+   Checks a face with its cmap copied into native byte order supports the
+   same characters as one reading the font's own, and gives each of them the
+   same glyph, by shaping every character supported a run at a time. */
+
+#define RUN 64
+
+int main(int argc, char **argv)
+{
+    const gr_uint32 *directBits, *nativeBits;
+    gr_uint32 directLimit, nativeLimit, usv, text[RUN];
+    gr_face *direct, *native;
+    size_t n = 0, numChars = 0;
+
+    if (argc < 2) return 1;
+    direct = gr_make_file_face(argv[1], 0);
+    native = gr_make_file_face(argv[1], gr_face_nativeCmap);
+    if (!direct || !native) return 1;
+
+    directBits = gr_face_coverage(direct, &directLimit);
+    nativeBits = gr_face_coverage(native, &nativeLimit);
+    if (!directBits || !nativeBits || directLimit != nativeLimit
+        || memcmp(directBits, nativeBits, directLimit / 8))
+        return 2;
+
+    for (usv = 0; usv <= directLimit; ++usv)
+    {
+        if (usv < directLimit && !((directBits[usv >> 5] >> (usv & 31)) & 1)) continue;
+        if (usv < directLimit) text[n++] = usv;
+        if (n == RUN || (usv == directLimit && n))
+        {
+            gr_segment *a = gr_make_seg(NULL, direct, 0, 0, gr_utf32, text, n, 0);
+            gr_segment *b = gr_make_seg(NULL, native, 0, 0, gr_utf32, text, n, 0);
+            if (!a || !b) return 3;
+            if (seg_differ(a, b)) return 4;
+            gr_seg_destroy(a);
+            gr_seg_destroy(b);
+            numChars += n;
+            n = 0;
+        }
+    }
+    printf("%lu characters mapped alike\n", (unsigned long)numChars);
+
+    gr_face_destroy(direct);
+    gr_face_destroy(native);
+    return 0;
+}
@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "segcompare.h"
+
+/* usage: ./preload fontfile.ttf string
+   Warms a face for the string, checks that reads in some but not all of its
+   glyphs, that doing so again reads nothing and that the string is read up
+   to its nul when given as longer, then checks the string comes out just as
+   it does from a face that read every glyph up front. */
+
+int main(int argc, char **argv)
+{
+    gr_face *warmed, *loaded, *early;
+    gr_font *warmedFont, *loadedFont;
+    gr_segment *a, *b;
+    size_t numChars, numRead;
+
+    if (argc < 3) return 1;
+    warmed = gr_make_file_face(argv[1], 0);
+    loaded = gr_make_file_face(argv[1], gr_face_preloadGlyphs);
+    if (!warmed || !loaded) return 1;
+    numChars = gr_count_unicode_characters(gr_utf8, argv[2], NULL, NULL);
+
+    numRead = gr_face_preload_text(warmed, gr_utf8, argv[2], numChars);
+    printf("%lu of %u glyphs read in\n", (unsigned long)numRead, gr_face_n_glyphs(warmed));
+    if (numRead == 0 || numRead >= gr_face_n_glyphs(warmed)) return 2;
+    if (gr_face_preload_text(warmed, gr_utf8, argv[2], numChars) != 0) return 3;
+    if (gr_face_preload_text(loaded, gr_utf8, argv[2], numChars) != 0) return 3;
+    /* Text ended early by a nul is still read up to there. */
+    early = gr_make_file_face(argv[1], 0);
+    if (!early) return 1;
+    if (gr_face_preload_text(early, gr_utf8, argv[2], numChars + 100) != numRead) return 6;
+    gr_face_destroy(early);
+
+    warmedFont = gr_make_font(12, warmed);
+    loadedFont = gr_make_font(12, loaded);
+    if (!warmedFont || !loadedFont) return 4;
+    a = gr_make_seg(warmedFont, warmed, 0, 0, gr_utf8, argv[2], numChars, 0);
+    b = gr_make_seg(loadedFont, loaded, 0, 0, gr_utf8, argv[2], numChars, 0);
+    if (!a || !b || seg_differ(a, b)) return 5;
+
+    gr_seg_destroy(a);
+    gr_seg_destroy(b);
+    gr_font_destroy(warmedFont);
+    gr_font_destroy(loadedFont);
+    gr_face_destroy(warmed);
+    gr_face_destroy(loaded);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <string.h>
+
+/* usage: ./profile fontfile.ttf string */
+int main(int argc, char **argv)
+{
+    char *pError;               /* location of faulty utf-8 */
+    gr_font *font = NULL;
+    size_t numCodePoints = 0;
+    gr_segment * seg = NULL;
+    gr_profile_counts total, rule;
+    unsigned int pass;
+    int numRules, i;
+    size_t fsm_runs = 0;
+    gr_face *face;
+
+    if (argc < 3) return 1;
+    face = gr_make_file_face(argv[1], gr_face_collectProfile);              /*<1>*/
+    if (!face) return 1;
+    font = gr_make_font(12, face);
+    if (!font) return 2;
+    numCodePoints = gr_count_unicode_characters(gr_utf8, argv[2], NULL,
+                (const void **)(&pError));
+    if (pError) return 3;
+    seg = gr_make_seg(font, face, 0, 0, gr_utf8, argv[2], numCodePoints, 0);
+    if (!seg) return 3;
+
+    for (pass = 0; (numRules = gr_face_profile(face, 0, pass, -1, &total)) >= 0; ++pass)  /*<2>*/
+    {
+        gr_profile_counts sum;
+        memset(&sum, 0, sizeof(sum));
+        for (i = 0; i < numRules; ++i)                                      /*<3>*/
+        {
+            if (gr_face_profile(face, 0, pass, i, &rule) != numRules) return 4;
+            sum.rules_considered += rule.rules_considered;
+            sum.constraints_run += rule.constraints_run;
+            sum.constraints_passed += rule.constraints_passed;
+            sum.actions_run += rule.actions_run;
+            sum.instructions += rule.instructions;
+        }
+        if (sum.rules_considered != total.rules_considered
+         || sum.constraints_run != total.constraints_run
+         || sum.constraints_passed != total.constraints_passed
+         || sum.actions_run != total.actions_run
+         || sum.instructions != total.instructions
+         || total.constraints_passed > total.constraints_run
+         || total.constraints_run > total.rules_considered
+         || total.instructions < total.actions_run)
+            return 5;
+        fsm_runs += total.fsm_runs;
+        printf("pass %u: %lu fsm runs, %lu rules, %lu actions\n", pass, (unsigned long)total.fsm_runs,
+               (unsigned long)total.rules_considered, (unsigned long)total.actions_run);
+    }
+    if (pass == 0 || fsm_runs == 0) return 6;
+    numRules = gr_face_profile(face, 0, 0, -1, NULL);
+    if (gr_face_profile(face, 0, 0, numRules, NULL) >= 0) return 7;
+
+    gr_seg_destroy(seg);
+    gr_font_destroy(font);
+    gr_face_destroy(face);
+    return 0;
+}
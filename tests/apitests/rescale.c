@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "segcompare.h"
+
+/* usage: ./rescale fontfile.ttf rtl string
+   Shapes the string once in design units, then rescales that segment for
+   several sizes and checks each comes out just as shaping at that size does. */
+
+static const float sizes[] = { 8.f, 12.f, 16.5f, 24.f, 72.f };
+
+int main(int argc, char **argv)
+{
+    gr_segment *design, *once, *direct;
+    size_t numChars, i;
+    gr_face *face;
+    gr_font *font;
+    int rtl;
+
+    if (argc < 4) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+    rtl = atoi(argv[2]);
+    numChars = gr_count_unicode_characters(gr_utf8, argv[3], NULL, NULL);
+    design = gr_make_seg(NULL, face, 0, 0, gr_utf8, argv[3], numChars, rtl);
+    once = gr_make_seg(NULL, face, 0, 0, gr_utf8, argv[3], numChars, rtl);
+    if (!design || !once) return 2;
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        font = gr_make_font(sizes[i], face);
+        if (!font) return 3;
+        direct = gr_make_seg(font, face, 0, 0, gr_utf8, argv[3], numChars, rtl);
+        if (!direct) return 3;
+        gr_seg_rescale(once, font);
+        if (seg_differ(once, direct)) return 4;
+        printf("%.1fppem: %d glyphs, advance %.3f\n", sizes[i], gr_seg_n_slots(once), gr_seg_advance_X(once));
+        gr_seg_destroy(direct);
+        gr_font_destroy(font);
+    }
+
+    /* and back to design units again */
+    gr_seg_rescale(once, NULL);
+    if (seg_differ(once, design)) return 5;
+
+    gr_seg_destroy(once);
+    gr_seg_destroy(design);
+    gr_face_destroy(face);
+    return 0;
+}
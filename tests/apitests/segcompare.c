@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include "segcompare.h"
+
+int seg_differ(gr_segment *a, gr_segment *b)
+{
+    const gr_slot *s, *t;
+    if (gr_seg_n_slots(a) != gr_seg_n_slots(b)
+        || gr_seg_advance_X(a) != gr_seg_advance_X(b)
+        || gr_seg_advance_Y(a) != gr_seg_advance_Y(b))
+        return 1;
+    for (s = gr_seg_first_slot(a), t = gr_seg_first_slot(b); s && t;
+         s = gr_slot_next_in_segment(s), t = gr_slot_next_in_segment(t))
+    {
+        if (gr_slot_gid(s) != gr_slot_gid(t)
+            || gr_slot_origin_X(s) != gr_slot_origin_X(t)
+            || gr_slot_origin_Y(s) != gr_slot_origin_Y(t))
+            return 1;
+    }
+    return s || t;
+}
@@ -0,0 +1,8 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#pragma once
+
+#include <graphite2/Segment.h>
+
+/* Returns non-zero if the two segments differ in any glyph or position. */
+int seg_differ(gr_segment *a, gr_segment *b);
@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later */
+/* Copyright 2026, SIL International, All rights reserved. */
+#include <graphite2/Segment.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "segcompare.h"
+
+/* usage: ./segfrombuffer fontfile.ttf string
+   Checks making a segment straight from a buffer, ended either by a pointer
+   or a nul, comes out just as counting the characters first and making it
+   from those does, and that a buffer ending part way through a character, or
+   with a bad one in it, gives no segment and points at the fault. */
+
+int main(int argc, char **argv)
+{
+    gr_segment *counted, *ended, *nul, *bad;
+    const void *error = NULL;
+    size_t numChars, len;
+    char *text;
+    gr_face *face;
+
+    if (argc < 3) return 1;
+    face = gr_make_file_face(argv[1], 0);
+    if (!face) return 1;
+    len = strlen(argv[2]);
+
+    numChars = gr_count_unicode_characters(gr_utf8, argv[2], NULL, NULL);
+    counted = gr_make_seg(NULL, face, 0, 0, gr_utf8, argv[2], numChars, 0);
+    ended = gr_make_seg_from_buffer(NULL, face, 0, 0, gr_utf8, argv[2], argv[2] + len, 0, &error);
+    if (!counted || !ended || error) return 2;
+    nul = gr_make_seg_from_buffer(NULL, face, 0, 0, gr_utf8, argv[2], NULL, 0, &error);
+    if (!nul || error) return 2;
+    if (gr_seg_n_cinfo(ended) != numChars || gr_seg_n_cinfo(nul) != numChars) return 3;
+    if (seg_differ(counted, ended) || seg_differ(counted, nul)) return 4;
+
+    /* Cut the last character short, should it take more than one byte. */
+    if (len && (unsigned char)argv[2][len - 1] >= 0x80)
+    {
+        text = (char *)malloc(len);
+        if (!text) return 1;
+        memcpy(text, argv[2], len - 1);
+        text[len - 1] = 0;
+        bad = gr_make_seg_from_buffer(NULL, face, 0, 0, gr_utf8, text, text + len - 1, 0, &error);
+        if (bad || error != text + len - 2) return 5;
+        free(text);
+    }
+    /* A fault part way through is found just where counting finds it. */
+    {
+        static const char broken[] = "ab\xC3(cd";
+        const void *countError = NULL;
+        gr_count_unicode_characters(gr_utf8, broken, broken + 6, &countError);
+        bad = gr_make_seg_from_buffer(NULL, face, 0, 0, gr_utf8, broken, broken + 6, 0, &error);
+        if (bad || !countError || error != countError) return 6;
+    }
+    printf("%lu characters read\n", (unsigned long)numChars);
+
+    gr_seg_destroy(counted);
+    gr_seg_destroy(ended);
+    gr_seg_destroy(nul);
+    gr_face_destroy(face);
+    return 0;
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+/*
+Description:
+Gives the slots of a segment character ranges that overlap far more than
+shaping usually makes them, as wide ligatures with glyphs inserted around
+them do, so associateChars runs out of budget for its single sweep and hands
+the characters out another way.  Checks that comes to just what the single
+sweep would have:  charassoc fontfile.ttf
+*/
+
+#include <cstdio>
+#include <vector>
+#include "inc/Face.h"
+#include "inc/FileFace.h"
+#include "inc/Segment.h"
+#include "inc/Slot.h"
+
+using namespace graphite2;
+
+namespace
+{
+    const int NUM_CHARS = 200;
+
+    unsigned int seed = 1;
+
+    int rnd(int n)
+    {
+        seed = seed * 1103515245 + 12345;
+        return int((seed >> 8) & 0xFFFF) % n;
+    }
+
+    struct Assoc
+    {
+        std::vector<int> before, after;     // each slot's, then each char's
+        std::vector<int> cbefore, cafter;
+    };
+
+    // The single sweep over every slot's range, then the filling in of
+    // characters no slot covers, as associateChars does within its budget.
+    void sweep(Assoc & r)
+    {
+        const int nslots = int(r.before.size());
+        r.cbefore.assign(NUM_CHARS, -1);
+        r.cafter.assign(NUM_CHARS, -1);
+        for (int i = 0; i != nslots; ++i)
+            for (int j = r.before[i]; j >= 0 && j <= r.after[i]; ++j)
+            {
+                if (r.cbefore[j] == -1 || i < r.cbefore[j]) r.cbefore[j] = i;
+                if (r.cafter[j] < i)                        r.cafter[j] = i;
+            }
+        for (int i = 0; i != nslots; ++i)
+        {
+            int a;
+            for (a = r.after[i] + 1; a < NUM_CHARS && r.cafter[a] < 0; ++a)
+                r.cafter[a] = i;
+            r.after[i] = a - 1;
+            for (a = r.before[i] - 1; a >= 0 && r.cbefore[a] < 0; --a)
+                r.cbefore[a] = i;
+            r.before[i] = a + 1;
+        }
+    }
+
+    int check(const Face & face, const char * name, const Assoc & ranges)
+    {
+        static gr_uint32 text[NUM_CHARS];
+        for (int j = 0; j != NUM_CHARS; ++j) text[j] = 'a' + j % 26;
+
+        Segment seg(NUM_CHARS, &face, 0, 0);
+        if (!seg.read_text(&face, &face.theSill().features(0), gr_utf32, text, NUM_CHARS))
+            return 1;
+        long covered = 0;
+        int i = 0;
+        for (Slot * s = seg.first(); s; s = s->next(), ++i)
+        {
+            s->before(ranges.before[i]);
+            s->after(ranges.after[i]);
+            if (ranges.before[i] >= 0) covered += ranges.after[i] - ranges.before[i] + 1;
+        }
+        // Past this budget associateChars gives up on the sweep.
+        if (covered <= 4 * NUM_CHARS + 16)
+        {
+            printf("%s: only %ld characters covered\n", name, covered);
+            return 1;
+        }
+
+        Assoc want = ranges;
+        sweep(want);
+        if (!seg.associateChars(0, NUM_CHARS)) return 1;
+
+        int bad = 0;
+        i = 0;
+        for (const Slot * s = seg.first(); s; s = s->next(), ++i)
+            bad += s->before() != want.before[i] || s->after() != want.after[i];
+        for (int j = 0; j != NUM_CHARS; ++j)
+            bad += seg.charinfo(j)->before() != want.cbefore[j] || seg.charinfo(j)->after() != want.cafter[j];
+        printf("%s: %ld characters covered, %d differ\n", name, covered, bad);
+        return bad != 0;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) return 1;
+    FileFace file(argv[1]);
+    if (!file) return 2;
+    Face face(&file, FileFace::ops);
+    Face::Table silf(face, Tag::Silf, 0x00050000);
+    if (!silf || !face.readGlyphs(0) || !face.readFeatures() || !face.readGraphite(silf))
+        return 2;
+
+    int ret = 0;
+    Assoc r;
+
+    // Every slot a ligature of every character.
+    r.before.assign(NUM_CHARS, 0);
+    r.after.assign(NUM_CHARS, NUM_CHARS - 1);
+    ret |= check(face, "whole", r);
+
+    // Wide ranges around each slot's own character, some slots not tied to
+    // any, and a stretch near the end covered by none.
+    for (int i = 0; i != NUM_CHARS; ++i)
+    {
+        const int b = max(0, i - rnd(40)), a = min(NUM_CHARS - 20, i + rnd(40));
+        const bool none = rnd(10) == 0 || b > a;
+        r.before[i] = none ? -1 : b;
+        r.after[i] = none ? -1 : a;
+    }
+    ret |= check(face, "wide", r);
+
+    // Ranges out of order, each reaching back across those before it.
+    for (int i = 0; i != NUM_CHARS; ++i)
+    {
+        r.before[i] = NUM_CHARS - 1 - i - rnd(min(i + 1, 60)) + (i ? 1 : 0);
+        if (r.before[i] < 0) r.before[i] = 0;
+        r.after[i] = min(NUM_CHARS - 1, r.before[i] + 10 + rnd(40));
+    }
+    ret |= check(face, "reversed", r);
+
+    return ret;
+}
@@ -49,7 +49,7 @@ int main(int argc, char **argv)
     FT_Library ftlib;
     FT_Face ftface;
     gr_face_ops faceops = {sizeof(gr_face_ops), &getTable, &releaseTable};          /*<2>*/
-    gr_font_ops fontops = {sizeof(gr_font_ops), &getAdvance, NULL};
+    gr_font_ops fontops = {sizeof(gr_font_ops), &getAdvance, NULL, NULL};
     /* Set up freetype font face at given point size */
     if (FT_Init_FreeType(&ftlib)) return -1;
     if (FT_New_Face(ftlib, argv[1], 0, &ftface)) return -2;
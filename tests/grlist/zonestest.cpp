@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+/*
+Description:
+Exercises the Zones exclusion set the shift collider uses, first with a few
+hand worked cases and then with a long run of generated ones shaped like
+those a collider makes for each glyph it fixes.  Given a repeat count it
+also times that run:  zonestest [repeats]
+*/
+#include "inc/Intervals.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace gr2 = graphite2;
+
+typedef std::pair<float, float> fpair;
+typedef std::vector<fpair> fvector;
+
+static int testCount = 0;
+
+void printZones(const char *pref, const gr2::Zones &z)
+{
+    printf ("%s: [ ", pref);
+    for (gr2::Zones::const_iterator s = z.begin(), end = z.end(); s != end; ++s)
+        printf("(%.1f, %.1f) ", s->x, s->xm);
+    printf ("]\n");
+}
+
+int doTest(const char *pref, const gr2::Zones &z, const fvector &fv)
+{
+    bool pass = size_t(z.end() - z.begin()) == fv.size();
+    fvector::const_iterator b = fv.begin();
+    for (gr2::Zones::const_iterator s = z.begin(), e = z.end(); pass && s != e; ++s, ++b)
+        pass = s->x == b->first && s->xm == b->second;
+    printf("%d %s) ", ++testCount, pass ? "pass" : "FAIL");
+    printZones(pref, z);
+    return pass ? 0 : 1;
+}
+
+int doClosestTest(const char *pref, const gr2::Zones &z, float origin, float pos, float cost)
+{
+    float c;
+    const float p = z.closest(origin, c);
+    bool pass = (p == pos && c == cost);
+    printf ("%d %s) %s: [ %.1f == %.1f, cost %.1f == %.1f ]\n", ++testCount, (pass ? "pass" : "FAIL"), pref, p, pos, c, cost);
+    return (pass ? 0 : 1);
+}
+
+namespace
+{
+    unsigned int seed;
+
+    float rnd(float lo, float hi)
+    {
+        seed = seed * 1103515245 + 12345;
+        return lo + (hi - lo) * float((seed >> 8) & 0xFFFF) / 65535.f;
+    }
+
+    // The zones for one axis of one glyph being fixed: limits, then the
+    // neighbours each either weighting a range or ruling it out, and finally
+    // the search for the best place.  Returns a hash of that result.
+    unsigned int fixGlyph(gr2::Zones &z, int axis)
+    {
+        const float margin = rnd(5, 50), weight = rnd(.5f, 2.f);
+        if (axis < 2)
+            z.initialise<gr2::XY>(rnd(-1500, -500), rnd(500, 1500), margin, weight, rnd(-200, 200));
+        else
+            z.initialise<gr2::SD>(rnd(-3000, -1000), rnd(1000, 3000), margin, weight, rnd(-400, 400));
+
+        for (int n = int(rnd(2, 16)); n; --n)
+        {
+            const float vmin = rnd(-1200, 1000), vmax = vmin + rnd(10, 600);
+            const float kind = rnd(0, 1);
+            if (kind < .6f)
+                z.weightedAxis(axis, vmin - margin, vmax + margin, 0, 0, 0, 0, 0, rnd(0, 2000), false);
+            else if (kind < .8f)
+                z.weightedAxis(axis, vmin, vmax, weight, rnd(-200, 200), rnd(0, 2), rnd(-500, 500), rnd(-50, 50), 0, kind < .7f);
+            else
+                z.exclude_with_margins(vmin, vmax, axis);
+        }
+
+        float cost, pos = z.closest(0, cost);
+        unsigned int h[2];
+        memcpy(h, &pos, sizeof(float));
+        memcpy(h + 1, &cost, sizeof(float));
+        return h[0] * 31 + h[1];
+    }
+
+    unsigned int run(int glyphs)
+    {
+        gr2::Zones zones[4];
+        unsigned int hash = 0;
+        seed = 1;
+        for (int n = 0; n != glyphs; ++n)
+            for (int axis = 0; axis != 4; ++axis)
+                hash = hash * 17 + fixGlyph(zones[axis], axis);
+        return hash;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int res = 0;
+    fvector base;
+    gr2::Zones z;
+
+    z.initialise<gr2::XY>(-100, 100, 10, 1, 0);
+    base.push_back(fpair(-100, 100));
+    res += doTest("initialise(-100,100)", z, base);
+    res += doClosestTest("closest(0)", z, 0, 0, 0);
+
+    z.exclude(-20, 30);
+    base.back() = fpair(-100, -20);
+    base.push_back(fpair(30, 100));
+    res += doTest("exclude(-20,30)", z, base);
+    res += doClosestTest("closest(0)", z, 0, -20, 400);
+
+    z.weighted<gr2::XY>(-60, 40, 0, 0, 0, 0, 0, 1000, false);
+    base.clear();
+    base.push_back(fpair(-100, -60));
+    base.push_back(fpair(-60, -20));
+    base.push_back(fpair(30, 40));
+    base.push_back(fpair(40, 100));
+    res += doTest("weighted(-60,40)", z, base);
+    res += doClosestTest("closest(0)", z, 0, -20, 1400);
+    res += doClosestTest("closest(80)", z, 80, 80, 0);
+
+    z.exclude_with_margins(-70, -50, 0);
+    base.clear();
+    base.push_back(fpair(-100, -80));
+    base.push_back(fpair(-80, -70));
+    base.push_back(fpair(-50, -40));
+    base.push_back(fpair(-40, -20));
+    base.push_back(fpair(30, 40));
+    base.push_back(fpair(40, 100));
+    res += doTest("exclude_with_margins(-70,-50)", z, base);
+    res += doClosestTest("closest(-60)", z, -60, -80, 400);
+
+    z.exclude(-200, 200);
+    base.clear();
+    res += doTest("exclude(-200,200)", z, base);
+    res += doClosestTest("closest(0)", z, 0, 0, -1);
+
+    // The generated run must keep giving exactly the same answers.
+    const unsigned int hash = run(4096);
+    const bool pass = hash == 0x2a4236ecu;
+    printf ("%d %s) generated: [ %08x ]\n", ++testCount, (pass ? "pass" : "FAIL"), hash);
+    res += pass ? 0 : 1;
+
+    const int repeats = argc > 1 ? atoi(argv[1]) : 0;
+    if (repeats > 0)
+    {
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        unsigned int sink = 0;
+        for (int r = 0; r != repeats; ++r)
+            sink += run(4096);
+        const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        printf ("%.1fns per glyph axis%s\n", ns / (repeats * 4096.0 * 4), sink == 1 ? " " : "");
+    }
+
+    return res;
+}
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
+// Copyright 2026, SIL International, All rights reserved.
+/*
+Description:
+Checks that every slice edge kernel this processor can run gives bit for bit
+the same results as the scalar one.  Given a repeat count it also times each
+of them:  sliceedges [repeats]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "inc/SliceEdges.h"
+
+using namespace graphite2;
+
+namespace
+{
+    const char * const names[SliceEdges::NUM_LEVELS] = { "scalar", "sse2", "avx2" };
+
+    unsigned int seed = 1;
+
+    // A small deterministic generator, so failures can be reproduced.
+    float rnd(float lo, float hi)
+    {
+        seed = seed * 1103515245 + 12345;
+        return lo + (hi - lo) * float((seed >> 8) & 0xFFFF) / 65535.f;
+    }
+
+    struct Glyph
+    {
+        int         numsub;
+        BBox        bb[4];
+        SlantBox    sb[4];
+        SliceEdges::Params p;
+    };
+
+    void make_box(BBox & bb, SlantBox & sb)
+    {
+        bb.xi = rnd(-300, 600);
+        bb.xa = bb.xi + rnd(0, 900);
+        bb.yi = rnd(-600, 900);
+        bb.ya = bb.yi + rnd(0, 1200);
+        // Trim the corners a little so the slant box matters.
+        sb.si = bb.xi + bb.yi + rnd(0, 200);
+        sb.sa = bb.xa + bb.ya - rnd(0, 200);
+        sb.di = bb.xi - bb.ya + rnd(0, 200);
+        sb.da = bb.xa - bb.yi - rnd(0, 200);
+    }
+
+    void make_glyph(Glyph & g)
+    {
+        g.numsub = int(rnd(0, 4.99f));
+        for (int i = 0; i < (g.numsub ? g.numsub : 1); ++i)
+            make_box(g.bb[i], g.sb[i]);
+        g.p.sx = rnd(-2000, 2000);
+        g.p.sy = rnd(-300, 300);
+        g.p.width = rnd(5, 60);
+        g.p.base = rnd(-900, -300) - 1;
+        g.p.margin = rnd(0, 1) < .5f ? 0.f : rnd(10, 100);
+        g.p.first = int(rnd(0, 80));
+        g.p.count = 1 + int(rnd(0, SliceEdges::MAX_SLICES - .01f));
+        g.p.right = rnd(0, 1) < .5f;
+    }
+
+    void edges(const SliceEdges::Kernel & k, const Glyph & g, float * res)
+    {
+        if (g.numsub)
+        {
+            SliceEdges::reset(g.p, res);
+            for (int i = 0; i < g.numsub; ++i)
+                k.sub(g.p, g.bb[i], g.sb[i], res);
+        }
+        else
+            k.whole(g.p, g.bb[0], g.sb[0], res);
+    }
+
+    const int NUM_GLYPHS = 4096;
+    Glyph glyphs[NUM_GLYPHS];
+}
+
+int main(int argc, char *argv[])
+{
+    const int repeats = argc > 1 ? atoi(argv[1]) : 0;
+    const SliceEdges::Kernel & scalar = *SliceEdges::at(SliceEdges::SCALAR);
+    int ret = 0;
+
+    for (int n = 0; n != NUM_GLYPHS; ++n)
+        make_glyph(glyphs[n]);
+
+    for (int l = 0; l != SliceEdges::NUM_LEVELS; ++l)
+    {
+        const SliceEdges::Kernel * const k = SliceEdges::at(SliceEdges::level(l));
+        if (!k)
+        {
+            std::cout << names[l] << ": not available" << std::endl;
+            continue;
+        }
+
+        int bad = 0;
+        for (int n = 0; n != NUM_GLYPHS; ++n)
+        {
+            float want[SliceEdges::MAX_SLICES], got[SliceEdges::MAX_SLICES];
+            edges(scalar, glyphs[n], want);
+            edges(*k, glyphs[n], got);
+            if (memcmp(want, got, glyphs[n].p.count * sizeof(float)) != 0)
+                ++bad;
+        }
+        std::cout << names[l] << ": " << bad << " of " << NUM_GLYPHS << " glyphs differ";
+        if (bad) ret = 1;
+
+        if (repeats > 0)
+        {
+            float res[SliceEdges::MAX_SLICES];
+            float sink = 0;
+            long slices = 0;
+            const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+            for (int r = 0; r != repeats; ++r)
+                for (int n = 0; n != NUM_GLYPHS; ++n)
+                {
+                    edges(*k, glyphs[n], res);
+                    sink += res[0];
+                    slices += glyphs[n].p.count;
+                }
+            const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << ", " << ns / double(slices) << "ns per slice" << (sink == 1 ? " " : "");
+        }
+        std::cout << std::endl;
+    }
+
+    return ret;
+}
@@ -1,7 +1,18 @@
 // SPDX-License-Identifier: MIT OR MPL-2.0 OR LGPL-2.1-or-later OR GPL-2.0-or-later
 // Copyright 2011, SIL International, All rights reserved.
+/*
+Description:
+Checks gr_count_unicode_characters against hand worked strings, on their own
+and behind plain text of every length up to a few blocks.  Given a text file
+and a repeat count it also times counting each line of it:
+utftest [textfile repeats]
+*/
 #include <graphite2/Segment.h>
+#include <chrono>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
 
 struct test8
 {
@@ -44,11 +55,83 @@ struct test16 tests16[] = {
 
 const int numtests16 = sizeof(tests16)/sizeof(test16);
 
+// Runs every test again behind each length of plain text up to a few
+// blocks long, so the counter's fast path meets every problem at every
+// offset, and checks the count and any error move along with it.
+int padded_tests(const char * prog)
+{
+    unsigned char str8[64 + sizeof tests8[0].str];
+    unsigned short str16[64 + sizeof tests16[0].str / sizeof tests16[0].str[0]];
+    const void * error;
+
+    for (int pad = 1; pad <= 64; ++pad)
+    {
+        for (int i = 0; i < numtests8; ++i)
+        {
+            for (int j = 0; j < pad; ++j) str8[j] = 'a' + j % 26;
+            memcpy(str8 + pad, tests8[i].str, sizeof tests8[i].str);
+            const size_t res = gr_count_unicode_characters(gr_utf8, str8, str8 + pad + sizeof tests8[i].str, &error);
+            const int at = error ? int(static_cast<const unsigned char *>(error) - str8) : -1;
+            if (res != tests8[i].len + pad || at != (tests8[i].error >= 0 ? tests8[i].error + pad : -1))
+            {
+                fprintf(stderr, "%s: test 8:%d failed behind %d plain characters\n", prog, i + 1, pad);
+                return 100 + i + 1;
+            }
+        }
+        for (int i = 0; i < numtests16; ++i)
+        {
+            const size_t len = sizeof tests16[i].str / sizeof tests16[i].str[0];
+            for (int j = 0; j < pad; ++j) str16[j] = 0x0600 + j;
+            memcpy(str16 + pad, tests16[i].str, sizeof tests16[i].str);
+            const size_t res = gr_count_unicode_characters(gr_utf16, str16, str16 + pad + len, &error);
+            const int at = error ? int(static_cast<const char *>(error) - reinterpret_cast<const char *>(str16)) : -1;
+            if (res != tests16[i].len + pad || at != (tests16[i].error >= 0 ? tests16[i].error + 2 * pad : -1))
+            {
+                fprintf(stderr, "%s: test 16:%d failed behind %d plain characters\n", prog, i + 1, pad);
+                return 200 + i + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Counts the characters in each line of a UTF-8 text, as an application
+// would before making a segment of it, and reports the time per character.
+int time_text(const char * path, int repeats)
+{
+    FILE * f = fopen(path, "rb");
+    if (!f) return 1;
+    std::vector<char> text;
+    char buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof buf, f)) != 0;)
+        text.insert(text.end(), buf, buf + n);
+    fclose(f);
+
+    size_t chars = 0;
+    const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r != repeats; ++r)
+    {
+        for (const char * p = text.data(), * const end = p + text.size(); p < end;)
+        {
+            const char * e = static_cast<const char *>(memchr(p, '\n', end - p));
+            if (!e) e = end;
+            chars += gr_count_unicode_characters(gr_utf8, p, e, NULL);
+            p = e + 1;
+        }
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    printf("%s: %.2fns per character\n", path, chars ? ns / double(chars) : 0.);
+    return 0;
+}
+
 int main(int argc, char * argv[])
 {
     int i;
     const void * error;
 
+    if (argc > 2)
+        return time_text(argv[1], atoi(argv[2]));
+
     for (i = 0; i < numtests8; ++i)
     {
         size_t res = gr_count_unicode_characters(gr_utf8, tests8[i].str, tests8[i].str + sizeof(tests8[i].str), &error);
@@ -104,5 +187,5 @@ int main(int argc, char * argv[])
             return (i+1);
         }
     }
-    return 0;
+    return padded_tests(argv[0]);
 }